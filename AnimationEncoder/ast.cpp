@@ -25,16 +25,33 @@ SOFTWARE.
 #include <cstdio>
 #include <cstdlib>
 #include <cassert>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include <deque>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "ast.h"
 #include "storage.h"
 #include "image.h"
+#include "decoder.h"
+#include "trace.h"
 
 std::map<AnimationGroupKey, AnimationGroup> g_mapAnimGroups; ///< Available animation groups, point into #g_vAnimations.
+std::map<int, const NumberedSprite *> g_mapSpriteTable; ///< Numbered sprites by their number, point into #g_vSprites.
 
 /** Name of the program. */
 #define PROGNAME "encoder"
 
 static const int MAX_DISPLAY_COND = 12; ///< Max layer class.
+static const int MIN_FILL_RUN = 3; ///< Minimal number of pixels with the same colour to use a fill run.
+static const int MAX_VARINT_SIZE = 5; ///< Maximal number of bytes of an extended run length.
+static const int MAX_PALETTE_SIZE = 256; ///< Maximal number of colours in the palette of a sprite.
+static const int MAX_SPRITE_NUMBER = 65535; ///< Max number of a numbered sprite.
+static const int TABLE_INDEX_CHUNK = 256; ///< Number of recolour table indices computed before writing them.
+
+typedef std::map<uint32, int> ColourIndex; ///< Palette of a sprite, index of each RGB colour.
 
 //! Return the tile size to use if none was specified.
 /*!
@@ -130,6 +147,7 @@ FrameElement::FrameElement(int line)
 
 FrameElement::FrameElement(const FrameElement &fe)
 {
+    m_iLine = fe.m_iLine;
     m_iTop = fe.m_iTop;
     m_iLeft = fe.m_iLeft;
     m_iWidth = fe.m_iWidth;
@@ -151,6 +169,7 @@ FrameElement &FrameElement::operator=(const FrameElement &fe)
 {
     if (this != &fe)
     {
+        m_iLine = fe.m_iLine;
         m_iTop = fe.m_iTop;
         m_iLeft = fe.m_iLeft;
         m_iWidth = fe.m_iWidth;
@@ -289,25 +308,41 @@ void FrameElement::Check()
     }
 }
 
+//! Find for each pixel the first recoloured pixel at or after it.
+/*!
+    @param iPixCount Number of pixels in the image.
+    @param pLayer Recolouring bitmap (if available).
+    @param pNext [out] Index of the next recoloured pixel for each pixel, or \a iPixCount if there is none.
+ */
+static void FindNextRecolour(const uint32 iPixCount, const Image8bpp *pLayer, std::vector<uint32> *pNext)
+{
+    pNext->clear();
+    if (pLayer == NULL) return;
+
+    pNext->resize(iPixCount);
+    uint32 iNext = iPixCount;
+    for (uint32 i = iPixCount; i > 0; i--)
+    {
+        if (pLayer->Get(i - 1) != 0) iNext = i - 1;
+        (*pNext)[i - 1] = iNext;
+    }
+}
+
 //! Look ahead in the recolour bitmaps to check when the next recoloured pixels will occur.
 /*!
     @param iCount Current index in the image.
     @param iEndCount End of the image.
-    @param pLayer Recolouring bitmap (if available).
-    @return Number of pixels to go before the next recoloured pixel (limited to 63 look ahead).
+    @param iMaxLength Maximum length of a run.
+    @param vNext Index of the next recoloured pixel for each pixel (empty if there is no recolour bitmap).
+    @return Number of pixels to go before the next recoloured pixel (limited to \a iMaxLength look ahead).
  */
-static int GetDistanceToNextRecolour(const uint32 iCount, const uint32 iEndCount, const Image8bpp *pLayer)
+static int GetDistanceToNextRecolour(const uint32 iCount, const uint32 iEndCount, const uint32 iMaxLength, const std::vector<uint32> &vNext)
 {
     uint32 iLength = iEndCount - iCount;
-    if (iLength > 63) iLength = 63; // No need to look ahead further.
+    if (iLength > iMaxLength) iLength = iMaxLength; // No need to look ahead further.
 
-    if (pLayer != NULL)
-    {
-        for (size_t i = 0; i < iLength; i++)
-        {
-            if (pLayer->Get(iCount + i) != 0) return i;
-        }
-    }
+    if (!vNext.empty() && vNext[iCount] - iCount < iLength)
+        return vNext[iCount] - iCount;
     return iLength;
 }
 
@@ -315,14 +350,15 @@ static int GetDistanceToNextRecolour(const uint32 iCount, const uint32 iEndCount
 /*!
     @param iCount Current index in the image.
     @param iEndCount End of the image.
+    @param iMaxLength Maximum length of a run.
     @param pLayer Recolouring bitmap.
     @param pLayerNumber [out] Number of the recolouring table to use.
     @return Number of pixels to recolour from the current position.
  */
-static int GetRecolourInformation(const uint32 iCount, const uint32 iEndCount, const Image8bpp *pLayer, uint8 *pLayerNumber)
+static int GetRecolourInformation(const uint32 iCount, const uint32 iEndCount, const uint32 iMaxLength, const Image8bpp *pLayer, uint8 *pLayerNumber)
 {
     uint32 iLength = iEndCount - iCount;
-    if (iLength > 63) iLength = 63; // No need to look ahead further.
+    if (iLength > iMaxLength) iLength = iMaxLength; // No need to look ahead further.
 
     *pLayerNumber = pLayer->Get(iCount);
     for (size_t i = 1; i < iLength; i++)
@@ -336,112 +372,829 @@ static int GetRecolourInformation(const uint32 iCount, const uint32 iEndCount, c
 /*!
     @param iCount Current index in the image.
     @param iEndCount End of the image.
+    @param iMaxLength Maximum length of a run.
     @param oBase Base image.
-    @return Number of pixels to go before the opacity of the current pixel changes (limited to 63 look ahead).
+    @return Number of pixels to go before the opacity of the current pixel changes (limited to \a iMaxLength look ahead).
  */
-static int GetDistanceToNextTransparency(const uint32 iCount, const uint32 iEndCount, const Image32bpp &oBase)
+static int GetDistanceToNextTransparency(const uint32 iCount, const uint32 iEndCount, const uint32 iMaxLength, const Image32bpp &oBase)
 {
     uint32 iLength = iEndCount - iCount;
-    if (iLength > 63) iLength = 63; // No need to look ahead further.
+    if (iLength > iMaxLength) iLength = iMaxLength; // No need to look ahead further.
 
-    uint8 iOpacity = GetA(oBase.Get(iCount));
-    for (unsigned int i = 1; i < iLength; i++)
+    uint8 iOpacity = oBase.GetOpacity(iCount);
+    unsigned int i = 1;
+    if (oBase.pOpacity != NULL)
     {
-        if (iOpacity != GetA(oBase.Get(iCount + i))) return i;
+        // Compare 8 opacities at a time.
+        const uint8 *pOpacity = oBase.pOpacity + iCount;
+        unsigned long long iExpected = iOpacity * 0x0101010101010101ULL;
+        for (; i + 8 <= iLength; i += 8)
+        {
+            unsigned long long iOpacities;
+            memcpy(&iOpacities, pOpacity + i, sizeof(iOpacities));
+            if (iOpacities != iExpected) break;
+        }
+        for (; i < iLength; i++)
+        {
+            if (iOpacity != pOpacity[i]) return i;
+        }
+        return iLength;
+    }
+    for (; i < iLength; i++)
+    {
+        if (iOpacity != oBase.GetOpacity(iCount + i)) return i;
     }
     return iLength;
 }
 
+//! Decide how many pixels to encode in a run with an opacity for each pixel.
+/*!
+    Sequences of pixels where the opacity changes often, such as glow effects
+    and anti-aliased edges, are shorter as a single RGBA run than as many
+    short runs with a fixed opacity.
+
+    @param iCount Current index in the image.
+    @param iEndCount End of the pixels that may be used (the next recoloured pixel).
+    @param oBase Base image.
+    @param iColourSize Number of bytes of a colour.
+    @return Number of pixels to write as RGBA run, \c 0 if fixed opacity runs are shorter.
+ */
+static int GetRgbaRunLength(const uint32 iCount, const uint32 iEndCount, const Image32bpp &oBase, int iColourSize)
+{
+    int iGain = -2; // Bytes saved by the RGBA run, which needs a header and an opacity marker.
+    int iBestGain = 0;
+    int iBestLength = 0;
+    uint32 iPos = iCount;
+    while (iPos < iEndCount)
+    {
+        int iLength = GetDistanceToNextTransparency(iPos, iEndCount, iEndCount - iPos, oBase);
+        uint8 iOpacity = oBase.GetOpacity(iPos);
+
+        int iSize = 2 + iColourSize * iLength; // Size of the run with fixed opacity.
+        if (iOpacity == OPAQUE) iSize = 1 + iColourSize * iLength;
+        if (iOpacity == TRANSPARENT) iSize = 1;
+
+        int iRgbaSize = (iColourSize + 1) * iLength;
+        if (iSize < iRgbaSize) break; // Pixels are shorter with fixed opacity.
+
+        iGain += iSize - iRgbaSize;
+        iPos += iLength;
+        if (iGain > iBestGain)
+        {
+            iBestGain = iGain;
+            iBestLength = iPos - iCount;
+        }
+    }
+    return iBestLength;
+}
+
+//! Look ahead in the base image to check how many pixels from the current position have the same colour.
+/*!
+    @param iCount Current index in the image.
+    @param iEndCount End of the pixels to examine.
+    @param oBase Base image.
+    @return Number of pixels to go before the colour or opacity of the current pixel changes.
+ */
+static int GetDistanceToNextColour(const uint32 iCount, const uint32 iEndCount, const Image32bpp &oBase)
+{
+    uint32 iColour = oBase.Get(iCount);
+    for (uint32 i = iCount + 1; i < iEndCount; i++)
+    {
+        if (iColour != oBase.Get(i)) return i - iCount;
+    }
+    return iEndCount - iCount;
+}
+
+//! Look ahead in the base image for the next pixels that are worth storing as fill run.
+/*!
+    @param iCount Current index in the image.
+    @param iEndCount End of the pixels to examine.
+    @param oBase Base image.
+    @return Number of pixels to go before the first pixel of a fill run (at least \c 1).
+ */
+static int GetDistanceToNextFill(const uint32 iCount, const uint32 iEndCount, const Image32bpp &oBase)
+{
+    uint32 iStart = iCount; // Start of the pixels with the same colour.
+    for (uint32 i = iCount + 1; i < iEndCount; i++)
+    {
+        if (oBase.Get(i) != oBase.Get(iStart))
+            iStart = i;
+        else if (i + 1 - iStart >= (uint32)MIN_FILL_RUN)
+            return (iStart > iCount) ? iStart - iCount : 1;
+    }
+    return iEndCount - iCount;
+}
+
 //! Write the RGB colour for the next \a iLength pixels, starting from the \a iCount offset.
 /*!
     @param oBase Base image to encode.
     @param iCount Current index in the image.
     @param iLength Number of pixels to process.
+    @param pPalette Palette of the sprite, if the colours are written as index.
     @param pDest Destination to write to.
  */
-static void WriteColour(const Image32bpp &oBase, uint32 iCount, int iLength, Output *pDest)
+static void WriteColour(const Image32bpp &oBase, uint32 iCount, int iLength, const ColourIndex *pPalette, Output *pDest)
 {
     while (iLength > 0)
     {
         uint32 iColour = oBase.Get(iCount);
         iCount++;
-        pDest->Uint8(GetR(iColour));
-        pDest->Uint8(GetG(iColour));
-        pDest->Uint8(GetB(iColour));
+        if (pPalette != NULL)
+        {
+            ColourIndex::const_iterator iter = pPalette->find(iColour & 0xFFFFFF);
+            pDest->Uint8((iter != pPalette->end()) ? (*iter).second : 0);
+        }
+        else
+        {
+            pDest->Uint8(GetR(iColour));
+            pDest->Uint8(GetG(iColour));
+            pDest->Uint8(GetB(iColour));
+        }
         iLength--;
     }
 }
 
-//! Write the table index for the next \a iLength pixels, starting from the \a iCount offset.
+//! Write the RGB colour and the opacity for the next \a iLength pixels, starting from the \a iCount offset.
 /*!
     @param oBase Base image to encode.
     @param iCount Current index in the image.
     @param iLength Number of pixels to process.
+    @param pPalette Palette of the sprite, if the colours are written as index.
     @param pDest Destination to write to.
  */
-static void WriteTableIndex(const Image32bpp &oBase, uint32 iCount, int iLength, Output *pDest)
+static void WriteColourOpacity(const Image32bpp &oBase, uint32 iCount, int iLength, const ColourIndex *pPalette, Output *pDest)
 {
     while (iLength > 0)
     {
-        uint32 iColour = oBase.Get(iCount);
+        WriteColour(oBase, iCount, 1, pPalette, pDest);
+        pDest->Uint8(oBase.GetOpacity(iCount));
         iCount++;
+        iLength--;
+    }
+}
+
+//! Compute the recolour table index (the biggest of the red, green, and blue channels) of pixels.
+/*!
+    With SSE2, 16 pixels are done at a time.
+    @param pPixels Pixels to compute.
+    @param iLength Number of pixels.
+    @param [out] pIndices Table index of each pixel.
+ */
+static void ComputeTableIndices(const uint32 *pPixels, int iLength, uint8 *pIndices)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i oLowByte = _mm_set1_epi32(0xFF);
+    for (; i + 16 <= iLength; i += 16)
+    {
+        __m128i aMax[4];
+        for (int j = 0; j < 4; j++)
+        {
+            // Red is the low byte of each pixel (see #MakeRGBA), shift green and blue down to it.
+            __m128i oPixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pPixels + i + 4 * j));
+            __m128i oMax = _mm_max_epu8(oPixels, _mm_srli_epi32(oPixels, 8));
+            oMax = _mm_max_epu8(oMax, _mm_srli_epi32(oPixels, 16));
+            aMax[j] = _mm_and_si128(oMax, oLowByte);
+        }
+        __m128i oWords1 = _mm_packs_epi32(aMax[0], aMax[1]);
+        __m128i oWords2 = _mm_packs_epi32(aMax[2], aMax[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pIndices + i), _mm_packus_epi16(oWords1, oWords2));
+    }
+#endif
+    for (; i < iLength; i++)
+    {
+        uint32 iColour = pPixels[i];
         uint8 biggest = GetR(iColour);
         if (biggest < GetG(iColour)) biggest = GetG(iColour);
         if (biggest < GetB(iColour)) biggest = GetB(iColour);
-        pDest->Uint8(biggest);
-        iLength--;
+        pIndices[i] = biggest;
+    }
+}
+
+//! Write the table index for the next \a iLength pixels, starting from the \a iCount offset.
+/*!
+    @param oBase Base image to encode.
+    @param iCount Current index in the image.
+    @param iLength Number of pixels to process.
+    @param pDest Destination to write to.
+ */
+static void WriteTableIndex(const Image32bpp &oBase, uint32 iCount, int iLength, Output *pDest)
+{
+    uint8 aIndices[TABLE_INDEX_CHUNK];
+    while (iLength > 0)
+    {
+        int iChunk = (iLength < TABLE_INDEX_CHUNK) ? iLength : TABLE_INDEX_CHUNK;
+        ComputeTableIndices(oBase.pData + iCount, iChunk, aIndices);
+        pDest->Bytes(aIndices, iChunk);
+        iCount += iChunk;
+        iLength -= iChunk;
+    }
+}
+
+//! Write the header of a run of pixels.
+/*!
+    A run longer than #MAX_SHORT_RUN pixels is written with an extended length
+    if that is shorter than splitting it, else only its first #MAX_SHORT_RUN
+    pixels are written.
+
+    @param iType Type of the run (upper two bits of the header).
+    @param iLength Number of pixels in the run.
+    @param iOverhead Number of bytes before the pixel data of a short run, including the header.
+    @param pDest Destination to write to.
+    @return Number of pixels in the written run.
+ */
+static int WriteRunHeader(int iType, int iLength, int iOverhead, Output *pDest)
+{
+    if (iLength <= MAX_SHORT_RUN)
+    {
+        pDest->Uint8(iType + iLength);
+        return iLength;
+    }
+
+    int iShortSize = iOverhead * ((iLength + MAX_SHORT_RUN - 1) / MAX_SHORT_RUN);
+    int iLongSize = iOverhead + Output::VarintSize(iLength);
+    if (iLongSize >= iShortSize)
+    {
+        pDest->Uint8(iType + MAX_SHORT_RUN);
+        return MAX_SHORT_RUN;
+    }
+
+    pDest->Uint8(iType); // Length 0 denotes an extended length.
+    pDest->Varint(iLength);
+    return iLength;
+}
+
+//! Kinds of runs of pixels.
+enum RunKind
+{
+    RK_FIXED, ///< Run with a fixed opacity (or recolour table), the type follows from its first pixel.
+    RK_RGBA,  ///< Run with an opacity for each pixel.
+    RK_FILL,  ///< Run of fully opaque pixels with the same colour.
+};
+
+//! Write a run of pixels, splitting it if the run header cannot hold its length.
+/*!
+    @param iCount Current index in the image.
+    @param iLength Number of pixels in the run.
+    @param eKind Kind of run to write.
+    @param oBase Base image to encode.
+    @param pLayer Recolouring bitmap (if available).
+    @param pNumber Recolour table to use for each recolour layer.
+    @param pPalette Palette of the sprite, if the colours are written as index.
+    @param pDest Destination to write to.
+ */
+static void WriteRun(uint32 iCount, int iLength, RunKind eKind, const Image32bpp &oBase, const Image8bpp *pLayer, const unsigned char *pNumber, const ColourIndex *pPalette, Output *pDest)
+{
+    const int iColourSize = (pPalette != NULL) ? 1 : 3;
+    uint8 iOpacity = oBase.GetOpacity(iCount);
+    while (iLength > 0)
+    {
+        int iWritten;
+        if (eKind == RK_FILL)
+        {
+            iWritten = WriteRunHeader(64, iLength, 2 + iColourSize, pDest);
+            pDest->Uint8(FILL_RUN_OPACITY);
+            WriteColour(oBase, iCount, 1, pPalette, pDest);
+        }
+        else if (eKind == RK_RGBA)
+        {
+            iWritten = WriteRunHeader(64, iLength, 2, pDest);
+            pDest->Uint8(RGBA_RUN_OPACITY);
+            WriteColourOpacity(oBase, iCount, iWritten, pPalette, pDest);
+        }
+        else if (pLayer != NULL && pLayer->Get(iCount) != 0)
+        {
+            iWritten = WriteRunHeader(64 + 128, iLength, 3, pDest);
+            pDest->Uint8(pNumber[pLayer->Get(iCount)]);
+            pDest->Uint8(iOpacity);
+            WriteTableIndex(oBase, iCount, iWritten, pDest);
+        }
+        else if (iOpacity == OPAQUE)
+        {
+            iWritten = WriteRunHeader(0, iLength, 1, pDest);
+            WriteColour(oBase, iCount, iWritten, pPalette, pDest);
+        }
+        else if (iOpacity == TRANSPARENT)
+        {
+            iWritten = WriteRunHeader(128, iLength, 1, pDest);
+        }
+        else
+        {
+            iWritten = WriteRunHeader(64, iLength, 2, pDest);
+            pDest->Uint8(iOpacity);
+            WriteColour(oBase, iCount, iWritten, pPalette, pDest);
+        }
+        iCount += iWritten;
+        iLength -= iWritten;
+    }
+}
+
+//! Cheapest way found so far to end a run at some pixel, for #EncodeOptimal.
+class RunChoice
+{
+public:
+    RunChoice() : m_iCost(0), m_iStart(0), m_eKind(RK_FIXED) { }
+
+    //! Use the run if it is cheaper than the current choice.
+    /*!
+        @param iCost Number of bytes of all pixels up to the end of the run.
+        @param iStart Start of the run.
+        @param eKind Kind of the run.
+     */
+    void Offer(int iCost, int iStart, RunKind eKind)
+    {
+        if (m_iStart < 0 || iCost < m_iCost)
+        {
+            m_iCost = iCost;
+            m_iStart = iStart;
+            m_eKind = eKind;
+        }
+    }
+
+    int m_iCost;  ///< Number of bytes to encode all pixels up to here.
+    int m_iStart; ///< Start of the last run (\c -1 means no run found yet).
+    RunKind m_eKind; ///< Kind of the last run.
+};
+
+//! Starts of the long runs of one run kind for #OfferRuns.
+/*!
+    The size of the extended length of a run grows with its length, so the
+    cheapest start is tracked separately for each size of the length. Each
+    size has a window of starts, ordered by position and by increasing cost
+    before them (relative to the pixel data), so the cheapest start of a
+    window is at its front.
+ */
+class LongRunStarts
+{
+public:
+    std::deque<int> m_aStarts[MAX_VARINT_SIZE + 1]; ///< Starts of the long runs, for each size of their length.
+};
+
+//! Add a start of long runs with an extended length of \a iSize bytes.
+/*!
+    @param vChoices Cheapest encoding for the pixels before every position.
+    @param j Start to add.
+    @param iPixelSize Number of bytes for each pixel.
+    @param [inout] pStarts Starts of the long runs with that size of the length.
+ */
+static void AddLongStart(const std::vector<RunChoice> &vChoices, int j, int iPixelSize, std::deque<int> *pStarts)
+{
+    int iKey = vChoices[j].m_iCost - iPixelSize * j;
+    while (!pStarts->empty() && vChoices[pStarts->back()].m_iCost - iPixelSize * pStarts->back() >= iKey)
+        pStarts->pop_back();
+    pStarts->push_back(j);
+}
+
+//! Find the cheapest run of a single run class that ends at pixel \a i.
+/*!
+    @param vChoices Cheapest encoding for the pixels before every position.
+    @param i End of the run.
+    @param iClassStart First pixel that may be in the run.
+    @param iMaxLength Maximum length of a run.
+    @param iOverhead Number of bytes before the pixel data of a run, including the header.
+    @param iPixelSize Number of bytes for each pixel.
+    @param [inout] pLong Starts of the long runs ending before \a i.
+    @param eKind Kind of the runs.
+    @param pChoice [inout] Choice of run to update.
+ */
+static void OfferRuns(const std::vector<RunChoice> &vChoices, int i, int iClassStart, int iMaxLength, int iOverhead, int iPixelSize, LongRunStarts *pLong, RunKind eKind, RunChoice *pChoice)
+{
+    // Runs with the length in the header.
+    int iFirst = i - MAX_SHORT_RUN;
+    if (iFirst < iClassStart) iFirst = iClassStart;
+    for (int j = iFirst; j < i; j++)
+        pChoice->Offer(vChoices[j].m_iCost + iOverhead + iPixelSize * (i - j), j, eKind);
+
+    // Runs with an extended length of iSize bytes have a length from
+    // iShortest up to iLongest. Moving forward, a start enters the window
+    // of a size when its run gets long enough, and leaves it when its run
+    // gets too long.
+    if (iMaxLength <= MAX_SHORT_RUN) return;
+
+    int iShortest = MAX_SHORT_RUN + 1;
+    for (int iSize = 1; iSize <= MAX_VARINT_SIZE && iShortest <= iMaxLength; iSize++)
+    {
+        int iLongest = (iSize < MAX_VARINT_SIZE) ? (1 << (7 * iSize)) - 1 : iMaxLength;
+        if (iLongest > iMaxLength) iLongest = iMaxLength;
+
+        std::deque<int> &starts = pLong->m_aStarts[iSize];
+        int j = i - iShortest;
+        if (j >= iClassStart) AddLongStart(vChoices, j, iPixelSize, &starts);
+        while (!starts.empty() && (starts.front() < iClassStart || i - starts.front() > iLongest))
+            starts.pop_front();
+
+        if (!starts.empty())
+        {
+            j = starts.front();
+            pChoice->Offer(vChoices[j].m_iCost + iOverhead + iSize + iPixelSize * (i - j), j, eKind);
+        }
+        if (iLongest >= iMaxLength) break;
+        iShortest = iLongest + 1;
+    }
+}
+
+//! Encode pixels with the smallest number of bytes.
+/*!
+    Each pixel belongs to a run class (recolour table and opacity), and runs
+    contain pixels of a single class, except RGBA runs that allow all pixels
+    that are not recoloured, and fill runs that need the same colour as well. For each position the cheapest encoding of all
+    pixels before it is computed, from all runs that may end there.
+
+    @param iCount First pixel to encode.
+    @param iEndCount End of the pixels to encode.
+    @param iMaxLength Maximum length of a run.
+    @param oBase Base image to encode.
+    @param pLayer Recolouring bitmap (if available).
+    @param pNumber Recolour table to use for each recolour layer.
+    @param pPalette Palette of the sprite, if the colours are written as index.
+    @param pDest Destination to write to.
+ */
+static void EncodeOptimal(uint32 iCount, uint32 iEndCount, uint32 iMaxLength, const Image32bpp &oBase, const Image8bpp *pLayer, const unsigned char *pNumber, const ColourIndex *pPalette, Output *pDest)
+{
+    const int iColourSize = (pPalette != NULL) ? 1 : 3;
+    const int iNumPixels = iEndCount - iCount;
+    std::vector<RunChoice> vChoices(iNumPixels + 1);
+
+    int iClassStart = 0;  // First pixel with the same run class as the current pixel.
+    int iPlainStart = 0;  // First pixel of the not recoloured pixels up to the current pixel.
+    int iFillStart = 0;   // First pixel with the same colour as the current pixel.
+    LongRunStarts oLong;      // Starts of the long runs in the current run class.
+    LongRunStarts oPlainLong; // Starts of the long RGBA runs.
+    LongRunStarts oFillLong;  // Starts of the long fill runs.
+    for (int i = 1; i <= iNumPixels; i++)
+    {
+        uint32 iPixel = iCount + i - 1; // Last pixel of the runs ending at i.
+        uint8 iOpacity = oBase.GetOpacity(iPixel);
+        uint8 iLayer = (pLayer != NULL) ? pLayer->Get(iPixel) : 0;
+        if (i > 1 && (iOpacity != oBase.GetOpacity(iPixel - 1) || (pLayer != NULL && iLayer != pLayer->Get(iPixel - 1))))
+            iClassStart = i - 1;
+        if (iLayer != 0)
+            iPlainStart = i;
+        if (i > 1 && oBase.Get(iPixel) != oBase.Get(iPixel - 1))
+            iFillStart = i - 1;
+
+        int iOverhead = 2;
+        int iPixelSize = iColourSize;
+        if (iLayer != 0)
+        {
+            iOverhead = 3;
+            iPixelSize = 1;
+        }
+        else if (iOpacity == OPAQUE)
+        {
+            iOverhead = 1;
+        }
+        else if (iOpacity == TRANSPARENT)
+        {
+            iOverhead = 1;
+            iPixelSize = 0;
+        }
+
+        RunChoice &oChoice = vChoices[i];
+        oChoice.m_iStart = -1;
+        OfferRuns(vChoices, i, iClassStart, iMaxLength, iOverhead, iPixelSize, &oLong, RK_FIXED, &oChoice);
+        if (g_oSettings.m_bRgbaRuns && iLayer == 0)
+            OfferRuns(vChoices, i, iPlainStart, iMaxLength, 2, iColourSize + 1, &oPlainLong, RK_RGBA, &oChoice);
+        if (g_oSettings.m_bFillRuns && iLayer == 0 && iOpacity == OPAQUE)
+        {
+            int iStart = (iFillStart > iClassStart) ? iFillStart : iClassStart;
+            OfferRuns(vChoices, i, iStart, iMaxLength, 2 + iColourSize, 0, &oFillLong, RK_FILL, &oChoice);
+        }
+    }
+
+    // Collect the runs from the end, and write them from the start.
+    std::vector<int> vEnds;
+    for (int i = iNumPixels; i > 0; i = vChoices[i].m_iStart)
+        vEnds.push_back(i);
+
+    int iStart = 0;
+    for (std::vector<int>::reverse_iterator iter = vEnds.rbegin(); iter != vEnds.rend(); iter++)
+    {
+        WriteRun(iCount + iStart, *iter - iStart, vChoices[*iter].m_eKind, oBase, pLayer, pNumber, pPalette, pDest);
+        iStart = *iter;
+    }
+}
+
+//! Run of pixels written by the greedy encoder, for counting why the runs ended.
+class GreedyRun
+{
+public:
+    //! Constructor of a run.
+    /*!
+        @param iStart First pixel of the run.
+        @param iEnd End of the run (the first pixel after it).
+        @param iEndCount End of the pixels the run could use.
+        @param eType Type of the run.
+     */
+    GreedyRun(uint32 iStart, uint32 iEnd, uint32 iEndCount, RunType eType)
+    {
+        m_iStart = iStart;
+        m_iEnd = iEnd;
+        m_iEndCount = iEndCount;
+        m_eType = eType;
+    }
+
+    uint32 m_iStart;    ///< First pixel of the run.
+    uint32 m_iEnd;      ///< End of the run (the first pixel after it).
+    uint32 m_iEndCount; ///< End of the pixels the run could use.
+    RunType m_eType;    ///< Type of the run.
+};
+
+//! Count why the runs of the greedy encoder ended.
+/*!
+    A run is capped if it has #MAX_SHORT_RUN pixels while long runs are off,
+    and the next run continues it (same type, and for a fill run the same colour).
+    @param vRuns Runs of the sprite, in the order of writing.
+    @param oBase Base image of the sprite.
+    @param pLayer Recolouring bitmap (if available).
+    @param [inout] pEnds Counters of the reasons to update.
+ */
+static void CountRunEnds(const std::vector<GreedyRun> &vRuns, const Image32bpp &oBase, const Image8bpp *pLayer, RunEnds *pEnds)
+{
+    for (size_t i = 0; i < vRuns.size(); i++)
+    {
+        const GreedyRun &run = vRuns[i];
+        uint32 iEnd = run.m_iEnd;
+        if (iEnd >= run.m_iEndCount)
+        {
+            pEnds->m_iRowEnd++;
+            continue;
+        }
+        if (pLayer != NULL && pLayer->Get(iEnd) != pLayer->Get(iEnd - 1))
+        {
+            pEnds->m_iRecolour++;
+            continue;
+        }
+        // RGBA runs store the opacity of each pixel, a change does not end them.
+        if (run.m_eType != RT_RGBA && oBase.GetOpacity(iEnd) != oBase.GetOpacity(iEnd - 1))
+        {
+            pEnds->m_iOpacity++;
+            continue;
+        }
+
+        bool bContinued = i + 1 < vRuns.size() && vRuns[i + 1].m_eType == run.m_eType;
+        if (bContinued && run.m_eType == RT_FILL)
+            bContinued = oBase.Get(iEnd) == oBase.Get(iEnd - 1);
+        if (bContinued && !g_oSettings.m_bLongRuns && iEnd - run.m_iStart == (uint32)MAX_SHORT_RUN)
+            pEnds->m_iCapped++;
+        else
+            pEnds->m_iOther++;
     }
 }
 
 //! Encode a 32bpp image from the \a oBase image, and optionally the recolouring \a pLayer bitmap.
-static void Encode32bpp(int iWidth, int iHeight, const Image32bpp &oBase, const Image8bpp *pLayer, Output *pDest, const unsigned char *pNumber)
+/*!
+    @param iWidth Width of the image.
+    @param iHeight Height of the image.
+    @param oBase Base image to encode.
+    @param pLayer Recolouring bitmap (if available).
+    @param pDest Destination to write to.
+    @param pNumber Recolour table to use for each recolour layer.
+    @param iRowTable Address of the row offset table in \a pDest, or \c -1 if runs may cross row boundaries.
+    @param bOptimal Whether to select runs with the smallest total size, instead of taking the longest run each time.
+    @param pPalette Palette of the sprite, if the colours are written as index.
+    @param [inout] pEnds If not \c NULL, counters of the reasons of ending the runs (greedy runs only).
+ */
+static void Encode32bpp(int iWidth, int iHeight, const Image32bpp &oBase, const Image8bpp *pLayer, Output *pDest, const unsigned char *pNumber, int iRowTable, bool bOptimal, const ColourIndex *pPalette, RunEnds *pEnds = NULL)
 {
+    const int iColourSize = (pPalette != NULL) ? 1 : 3;
     const uint32 iPixCount = iWidth * iHeight;
+    const uint32 iMaxLength = g_oSettings.m_bLongRuns ? iPixCount : MAX_SHORT_RUN;
+    const int iDataStart = pDest->Reserve(0);
+    TraceSpan oSpan("Encode32bpp");
     uint32 iCount = 0;
+    uint32 iRunStart = 0;    // Start of the previous run, for counting why it ended.
+    uint32 iRunEndCount = 0; // End of the pixels the previous run could use.
+    RunType eRunType = RT_COUNT; // Type of the previous run.
+    std::vector<GreedyRun> vRuns; // Written runs, if counting why they end.
+    std::vector<uint32> vNextRecolour;
+    if (!bOptimal) FindNextRecolour(iPixCount, pLayer, &vNextRecolour);
     while (iCount < iPixCount)
     {
-        int iLength = GetDistanceToNextRecolour(iCount, iPixCount, pLayer);
-        int length2 = GetDistanceToNextTransparency(iCount, iPixCount, oBase);
+        if (pEnds != NULL && iRunStart < iCount)
+            vRuns.push_back(GreedyRun(iRunStart, iCount, iRunEndCount, eRunType));
+
+        uint32 iEndCount = iPixCount;
+        if (iRowTable >= 0) // Runs end at the end of the row.
+        {
+            uint32 iRow = iCount / iWidth;
+            iEndCount = (iRow + 1) * iWidth;
+            if (iCount == iRow * iWidth)
+                pDest->Write32(iRowTable + 4 * iRow, pDest->Reserve(0) - iDataStart);
+        }
+        iRunStart = iCount;
+        iRunEndCount = iEndCount;
+
+        if (bOptimal)
+        {
+            EncodeOptimal(iCount, iEndCount, iMaxLength, oBase, pLayer, pNumber, pPalette, pDest);
+            iCount = iEndCount;
+            continue;
+        }
+
+        int iLength = GetDistanceToNextRecolour(iCount, iEndCount, iMaxLength, vNextRecolour);
+        int length2 = GetDistanceToNextTransparency(iCount, iEndCount, iMaxLength, oBase);
 
-        if (iLength > 63) iLength = 63;
         if (iLength == 0) { // Recolour layer.
             uint8 iTableNumber;
-            iLength = GetRecolourInformation(iCount, iPixCount, pLayer, &iTableNumber);
+            iLength = GetRecolourInformation(iCount, iEndCount, iMaxLength, pLayer, &iTableNumber);
             if (length2 < iLength) iLength = length2;
             assert(iLength > 0);
 
-            pDest->Uint8(64 + 128 + iLength);
+            iLength = WriteRunHeader(64 + 128, iLength, 3, pDest);
             pDest->Uint8(pNumber[iTableNumber]);
-            pDest->Uint8(GetA(oBase.Get(iCount))); // Opacity.
+            pDest->Uint8(oBase.GetOpacity(iCount)); // Opacity.
             WriteTableIndex(oBase, iCount, iLength, pDest);
             iCount += iLength;
+            eRunType = RT_RECOLOUR;
             continue;
         }
+        if (g_oSettings.m_bRgbaRuns)
+        {
+            int iRgbaLength = GetRgbaRunLength(iCount, iCount + iLength, oBase, iColourSize);
+            if (iRgbaLength > 0) { // 32bpp pixels with their own opacity (RGBA).
+                iLength = WriteRunHeader(64, iRgbaLength, 2, pDest);
+                pDest->Uint8(RGBA_RUN_OPACITY);
+                WriteColourOpacity(oBase, iCount, iLength, pPalette, pDest);
+                iCount += iLength;
+                eRunType = RT_RGBA;
+                continue;
+            }
+        }
         if (length2 < iLength) iLength = length2;
         assert(iLength > 0);
 
-        uint8 iOpacity = GetA(oBase.Get(iCount));
+        uint8 iOpacity = oBase.GetOpacity(iCount);
+        if (iOpacity == OPAQUE && g_oSettings.m_bFillRuns)
+        {
+            int iFillLength = GetDistanceToNextColour(iCount, iCount + iLength, oBase);
+            if (iFillLength >= MIN_FILL_RUN) { // Fixed non-transparent pixels with a single colour.
+                iLength = WriteRunHeader(64, iFillLength, 2 + iColourSize, pDest);
+                pDest->Uint8(FILL_RUN_OPACITY);
+                WriteColour(oBase, iCount, 1, pPalette, pDest);
+                iCount += iLength;
+                eRunType = RT_FILL;
+                continue;
+            }
+            iLength = GetDistanceToNextFill(iCount, iCount + iLength, oBase);
+        }
         if (iOpacity == OPAQUE) { // Fixed non-transparent 32bpp pixels (RGB).
-            pDest->Uint8(iLength);
-            WriteColour(oBase, iCount, iLength, pDest);
+            iLength = WriteRunHeader(0, iLength, 1, pDest);
+            WriteColour(oBase, iCount, iLength, pPalette, pDest);
             iCount += iLength;
+            eRunType = RT_OPAQUE;
             continue;
         }
         if (iOpacity == TRANSPARENT) { // Fixed fully transparent pixels.
-            pDest->Uint8(128 + iLength);
+            iLength = WriteRunHeader(128, iLength, 1, pDest);
             iCount += iLength;
+            eRunType = RT_TRANSPARENT;
             continue;
         }
         /* Partially transparent 32bpp pixels (RGB). */
-        pDest->Uint8(64 + iLength);
+        iLength = WriteRunHeader(64, iLength, 2, pDest);
         pDest->Uint8(iOpacity);
-        WriteColour(oBase, iCount, iLength, pDest);
+        WriteColour(oBase, iCount, iLength, pPalette, pDest);
         iCount += iLength;
+        eRunType = RT_PARTIAL;
         continue;
     }
+    if (pEnds != NULL && iRunStart < iCount)
+    {
+        vRuns.push_back(GreedyRun(iRunStart, iCount, iRunEndCount, eRunType));
+        CountRunEnds(vRuns, oBase, pLayer, pEnds);
+    }
+    oSpan.SetBytes(pDest->Reserve(0) - iDataStart);
+}
+
+//! Snap the opacity of the pixels to fewer values, giving longer runs.
+/*!
+    Opacities within the snap distance of fully transparent or fully opaque become
+    fully transparent or fully opaque, other opacities are rounded to a multiple of the step.
+    @param pBase [inout] Base image of the sprite.
+    @param iSnap Snap distance.
+    @param iStep Step size of the partial opacities.
+    @return Number of changed pixels.
+ */
+static int SnapOpacity(Image32bpp *pBase, int iSnap, int iStep)
+{
+    int iChanged = 0;
+    for (int i = 0; i < pBase->iWidth * pBase->iHeight; i++)
+    {
+        uint32 iPixel = pBase->pData[i];
+        int iOpacity = GetA(iPixel);
+        int iNew;
+        if (iOpacity <= TRANSPARENT + iSnap)
+            iNew = TRANSPARENT;
+        else if (iOpacity >= OPAQUE - iSnap)
+            iNew = OPAQUE;
+        else
+        {
+            iNew = (iOpacity + iStep / 2) / iStep * iStep;
+            if (iNew > OPAQUE) iNew = OPAQUE;
+        }
+
+        if (iNew != iOpacity)
+        {
+            pBase->pData[i] = MakeRGBA(GetR(iPixel), GetG(iPixel), GetB(iPixel), iNew);
+            iChanged++;
+        }
+    }
+    return iChanged;
+}
+
+//! Collect the colours of the pixels that are stored as RGB.
+/*!
+    @param oBase Base image of the sprite.
+    @param pLayer Recolouring bitmap (if available).
+    @param pPalette [out] Palette of the sprite, the colours are numbered in increasing order.
+    @return Whether the colours fit in a palette.
+ */
+static bool MakePalette(const Image32bpp &oBase, const Image8bpp *pLayer, ColourIndex *pPalette)
+{
+    pPalette->clear();
+    for (int i = 0; i < oBase.iWidth * oBase.iHeight; i++)
+    {
+        if (pLayer != NULL && pLayer->Get(i) != 0) continue; // Recoloured pixels have no colour.
+        if (oBase.GetOpacity(i) == TRANSPARENT) continue;
+
+        (*pPalette)[oBase.Get(i) & 0xFFFFFF] = 0;
+        if (pPalette->size() > (size_t)MAX_PALETTE_SIZE) return false;
+    }
+
+    int iIndex = 0;
+    for (ColourIndex::iterator iter = pPalette->begin(); iter != pPalette->end(); ++iter)
+        iter->second = iIndex++;
+    return true;
+}
+
+//! Decode the written sprite, and check it matches with its source images.
+/*!
+    @param pOut Output containing the sprite.
+    @param iStart Address of the sprite block in \a pOut.
+    @param oBase Base image of the sprite.
+    @param pLayer Recolouring bitmap (if available).
+    @param pNumber Recolour table to use for each recolour layer.
+    @param line Line number of the sprite definition in the input file.
+ */
+static void VerifySprite(Output *pOut, int iStart, const Image32bpp &oBase, const Image8bpp *pLayer, const unsigned char *pNumber, int line)
+{
+    unsigned char *pData = pOut->GetData();
+    int iSize = pOut->GetSize() - iStart;
+    clock_t iStartTime = clock();
+    DecodedSprite *pSprite = DecodeSprite(pData + iStart, iSize, 0, -1);
+    g_oStatistics.m_fDecodeTime += (double)(clock() - iStartTime) / CLOCKS_PER_SEC;
+    g_oStatistics.m_iDecodedSprites++;
+    g_oStatistics.m_iDecodedPixels += oBase.iWidth * oBase.iHeight;
+    if (pSprite == NULL)
+    {
+        fprintf(stderr, "Sprite at line %d: Decoding the encoded sprite failed\n", line);
+        exit(1);
+    }
+
+    for (int i = 0; i < oBase.iWidth * oBase.iHeight; i++)
+    {
+        uint32 iColour = oBase.Get(i);
+        uint32 iDecoded = pSprite->pData[i];
+        bool bOk = GetA(iColour) == GetA(iDecoded);
+        if (pLayer != NULL && pLayer->Get(i) != 0)
+        {
+            uint8 biggest = GetR(iColour);
+            if (biggest < GetG(iColour)) biggest = GetG(iColour);
+            if (biggest < GetB(iColour)) biggest = GetB(iColour);
+            bOk = bOk && pSprite->pLayers[i] == pNumber[pLayer->Get(i)] && GetR(iDecoded) == biggest;
+        }
+        else
+        {
+            bOk = bOk && pSprite->pLayers[i] == -1;
+            if (GetA(iColour) != TRANSPARENT)
+                bOk = bOk && (iColour & 0xFFFFFF) == (iDecoded & 0xFFFFFF);
+        }
+
+        if (!bOk)
+        {
+            fprintf(stderr, "Sprite at line %d: Decoded sprite differs at pixel (%d, %d)\n",
+                    line, i % oBase.iWidth, i / oBase.iWidth);
+            exit(1);
+        }
+    }
+
+    // Decoding the bottom half only should give the same pixels.
+    int iFirstRow = oBase.iHeight / 2;
+    DecodedSprite *pPart = DecodeSprite(pData + iStart, iSize, iFirstRow, -1);
+    if (pPart == NULL || memcmp(pPart->pData, pSprite->pData + iFirstRow * oBase.iWidth,
+                                sizeof(uint32) * pPart->iWidth * pPart->iHeight) != 0)
+    {
+        fprintf(stderr, "Sprite at line %d: Decoding the rows from row %d failed\n", line, iFirstRow);
+        exit(1);
+    }
+
+    delete pPart;
+    delete pSprite;
+    free(pData);
 }
 
-bool FrameElement::WriteSprite(Output *pOut, int *iXoffset, int  *iYoffset) const
+bool FrameElement::WriteSprite(Output *pOut, int *iXoffset, int  *iYoffset, SpritePixels *pPixels, RunEnds *pEnds) const
 {
     int iLeft = m_iLeft;
     int iWidth = m_iWidth;
@@ -458,28 +1211,177 @@ bool FrameElement::WriteSprite(Output *pOut, int *iXoffset, int  *iYoffset) cons
     }
 
     Image8bpp *pLayer = NULL;
+    if (m_sRecolourImage != "" && g_oSettings.m_sAtlas != "")
+    {
+        fprintf(stderr, "Sprite at line %d: Recolour layers cannot be stored in atlas images\n", m_iLine);
+        exit(1);
+    }
     if (m_sRecolourImage != "")
         pLayer = Load8Bpp(m_sRecolourImage, m_iLine, iLeft, iWidth, iTop, iHeight);
 
+    if (g_oSettings.m_iAlphaSnap > 0 || g_oSettings.m_iAlphaStep > 1)
+    {
+        Image32bpp oOriginal(*pBase);
+        int iChanged = SnapOpacity(pBase, g_oSettings.m_iAlphaSnap, g_oSettings.m_iAlphaStep);
+        g_oStatistics.m_iSnappedPixels += iChanged;
+        if (iChanged > 0 && g_oSettings.m_bStats)
+        {
+            // Compare the size of the runs with the original opacities.
+            Output oOriginalRuns;
+            Encode32bpp(iWidth, iHeight, oOriginal, pLayer, &oOriginalRuns, m_aNumber, -1, false, NULL);
+            Output oSnappedRuns;
+            Encode32bpp(iWidth, iHeight, *pBase, pLayer, &oSnappedRuns, m_aNumber, -1, false, NULL);
+            g_oStatistics.m_iSnapSavedBytes += oOriginalRuns.GetSize() - oSnappedRuns.GetSize();
+        }
+    }
+
+    if (g_oSettings.m_bOpacityPlane)
+    {
+        clock_t iPlaneTime = clock();
+        pBase->MakeOpacityPlane();
+        g_oStatistics.m_fEncodeTime += (double)(clock() - iPlaneTime) / CLOCKS_PER_SEC; // Part of the encoding.
+    }
+
+    if (pPixels != NULL)
+    {
+        pPixels->m_iWidth = iWidth;
+        pPixels->m_iHeight = iHeight;
+        pPixels->m_vPixels.resize(2 * iWidth * iHeight);
+        for (int i = 0; i < iWidth * iHeight; i++)
+        {
+            uint8 iLayer = (pLayer != NULL) ? pLayer->Get(i) : 0;
+            pPixels->m_vPixels[2 * i] = pBase->Get(i);
+            pPixels->m_vPixels[2 * i + 1] = (iLayer == 0) ? 0 : 256 + m_aNumber[iLayer];
+        }
+    }
+
+    // Use a palette only if it makes the sprite smaller.
+    ColourIndex oPalette;
+    const ColourIndex *pPalette = NULL;
+    if (g_oSettings.m_bPalette && MakePalette(*pBase, pLayer, &oPalette) && !oPalette.empty())
+    {
+        Output oRgb;
+        Encode32bpp(iWidth, iHeight, *pBase, pLayer, &oRgb, m_aNumber, -1, g_oSettings.m_bOptimal, NULL);
+        Output oIndexed;
+        Encode32bpp(iWidth, iHeight, *pBase, pLayer, &oIndexed, m_aNumber, -1, g_oSettings.m_bOptimal, &oPalette);
+        if (1 + 3 * (int)oPalette.size() + oIndexed.GetSize() < oRgb.GetSize())
+        {
+            pPalette = &oPalette;
+            g_oStatistics.m_iPaletteSprites++;
+        }
+    }
+
+    int iFlags = 0;
+    if (g_oSettings.m_bRowTable) iFlags |= SPF_ROW_TABLE;
+    if (pPalette != NULL) iFlags |= SPF_PALETTE;
+
     int iStart = pOut->Reserve(0);
     pOut->Uint8('S');
-    pOut->Uint8('P');
+    pOut->Uint8((iFlags != 0) ? 'X' : 'P');
     pOut->Uint16(iWidth);
     pOut->Uint16(iHeight);
     int iAddress = pOut->Reserve(4);
     int iEnd = pOut->Reserve(0);
     assert(iEnd - iStart == SPRITE_NON_DATA_SIZE); // Non-data size must match.
 
-    Encode32bpp(iWidth, iHeight, *pBase, pLayer, pOut, m_aNumber);
+    int iRowTable = -1;
+    if (iFlags != 0)
+    {
+        pOut->Uint16(iFlags);
+        if ((iFlags & SPF_ROW_TABLE) != 0)
+            iRowTable = pOut->Reserve(4 * iHeight);
+        if ((iFlags & SPF_PALETTE) != 0)
+        {
+            std::vector<uint32> vColours(pPalette->size());
+            for (ColourIndex::const_iterator iter = pPalette->begin(); iter != pPalette->end(); ++iter)
+                vColours[iter->second] = iter->first;
+
+            pOut->Uint8(vColours.size() - 1);
+            for (size_t i = 0; i < vColours.size(); i++)
+            {
+                pOut->Uint8(GetR(vColours[i]));
+                pOut->Uint8(GetG(vColours[i]));
+                pOut->Uint8(GetB(vColours[i]));
+            }
+        }
+    }
+
+    int iDataStart = pOut->Reserve(0);
+    clock_t iStartTime = clock();
+    Encode32bpp(iWidth, iHeight, *pBase, pLayer, pOut, m_aNumber, iRowTable, g_oSettings.m_bOptimal, pPalette,
+                g_oSettings.m_bOptimal ? NULL : pEnds);
+    g_oStatistics.m_iEncodedPixels += iWidth * iHeight;
+    g_oStatistics.m_fEncodeTime += (double)(clock() - iStartTime) / CLOCKS_PER_SEC;
+    if (g_oSettings.m_bOptimal && g_oSettings.m_bStats)
+    {
+        // Compare with the size of the runs without optimizing.
+        double fTime = (double)(clock() - iStartTime) / CLOCKS_PER_SEC;
+        int iSize = pOut->Reserve(0) - iDataStart;
+
+        Output oGreedy;
+        int iGreedyTable = (iRowTable >= 0) ? oGreedy.Reserve(4 * iHeight) : -1;
+        int iGreedyStart = oGreedy.Reserve(0);
+        Encode32bpp(iWidth, iHeight, *pBase, pLayer, &oGreedy, m_aNumber, iGreedyTable, false, pPalette);
+        int iGreedySize = oGreedy.GetSize() - iGreedyStart;
+
+        printf("Sprite at line %d: %d bytes instead of %d bytes (%d saved) in %.3f ms\n",
+               m_iLine, iSize, iGreedySize, iGreedySize - iSize, fTime * 1000.0);
+        g_oStatistics.m_iGreedySize += iGreedySize;
+        g_oStatistics.m_iOptimalSize += iSize;
+        g_oStatistics.m_fOptimizeTime += fTime;
+    }
 
     int iLength = pOut->Reserve(0) - (iAddress + 4); // Start counting after the length.
     pOut->Write32(iAddress, iLength);
 
+    if (g_oSettings.m_bVerify)
+        VerifySprite(pOut, iStart, *pBase, pLayer, m_aNumber, m_iLine);
+
     delete pLayer;
     delete pBase;
     return true;
 }
 
+SpritePixels::SpritePixels()
+{
+    m_iWidth = 0;
+    m_iHeight = 0;
+}
+
+//! Get the pixels of the sprite flipped in the given directions.
+/*!
+    @param bHorizontal Flip the sprite horizontally (mirror the columns).
+    @param bVertical Flip the sprite vertically (mirror the rows).
+    @return The flipped pixels.
+ */
+SpritePixels SpritePixels::Mirror(bool bHorizontal, bool bVertical) const
+{
+    SpritePixels oFlipped;
+    oFlipped.m_iWidth = m_iWidth;
+    oFlipped.m_iHeight = m_iHeight;
+    oFlipped.m_vPixels.resize(m_vPixels.size());
+    for (int y = 0; y < m_iHeight; y++)
+    {
+        int iSrcY = bVertical ? m_iHeight - 1 - y : y;
+        for (int x = 0; x < m_iWidth; x++)
+        {
+            int iSrcX = bHorizontal ? m_iWidth - 1 - x : x;
+            int iDest = 2 * (y * m_iWidth + x);
+            int iSrc = 2 * (iSrcY * m_iWidth + iSrcX);
+            oFlipped.m_vPixels[iDest] = m_vPixels[iSrc];
+            oFlipped.m_vPixels[iDest + 1] = m_vPixels[iSrc + 1];
+        }
+    }
+    return oFlipped;
+}
+
+bool operator<(const SpritePixels &sp1, const SpritePixels &sp2)
+{
+    if (sp1.m_iWidth != sp2.m_iWidth) return sp1.m_iWidth < sp2.m_iWidth;
+    if (sp1.m_iHeight != sp2.m_iHeight) return sp1.m_iHeight < sp2.m_iHeight;
+    return sp1.m_vPixels < sp2.m_vPixels;
+}
+
 AnimationFrame::AnimationFrame()
 {
 }
@@ -664,6 +1566,56 @@ void Animation::Check()
     }
 }
 
+NumberedSprite::NumberedSprite()
+{
+}
+
+NumberedSprite::NumberedSprite(int line, int number) : m_oElement(line)
+{
+    m_iLine = line;
+    m_iNumber = number;
+}
+
+NumberedSprite::NumberedSprite(const NumberedSprite &ns)
+{
+    m_iLine = ns.m_iLine;
+    m_iNumber = ns.m_iNumber;
+    m_oElement = ns.m_oElement;
+}
+
+NumberedSprite &NumberedSprite::operator=(const NumberedSprite &ns)
+{
+    if (this != &ns)
+    {
+        m_iLine = ns.m_iLine;
+        m_iNumber = ns.m_iNumber;
+        m_oElement = ns.m_oElement;
+    }
+    return *this;
+}
+
+//! Set the properties of the sprite.
+/*!
+    @param fields Properties to assign.
+ */
+void NumberedSprite::SetProperties(const std::vector<FieldStorage> &fields)
+{
+    m_oElement.SetProperties(fields);
+}
+
+//! Perform integrity checking on the supplied data.
+void NumberedSprite::Check()
+{
+    if (m_iNumber < 0 || m_iNumber > MAX_SPRITE_NUMBER)
+    {
+        fprintf(stderr, PROGNAME ", line %d: Sprite number must be between "
+                "0 and %d\n", m_iLine, MAX_SPRITE_NUMBER);
+        exit(1);
+    }
+
+    m_oElement.Check();
+}
+
 AnimationGroupKey::AnimationGroupKey()
 {
     m_sName = "";
@@ -31,10 +31,27 @@ SOFTWARE.
 #include <string>
 
 class Output;
+class RunEnds;
 
 //! Number of bytes in a sprite block excluding the actual sprite data.
 static const int SPRITE_NON_DATA_SIZE = 10;
 
+//! Longest run of pixels with a length in the run header.
+static const int MAX_SHORT_RUN = 63;
+
+//! Opacity of a partially transparent run that denotes it has an opacity for each pixel (RGBA).
+static const int RGBA_RUN_OPACITY = 0;
+
+//! Opacity of a partially transparent run that denotes fully opaque pixels with a single colour.
+static const int FILL_RUN_OPACITY = 255;
+
+//! Flags of an extended ('S', 'X') sprite block.
+enum SpriteFlags
+{
+    SPF_ROW_TABLE = 0x1, ///< Sprite data starts with a table of row offsets, no run crosses a row boundary.
+    SPF_PALETTE   = 0x2, ///< Colours of the sprite are stored as index in a palette of the sprite.
+};
+
 //! Enumeration listing the fields of the data structures.
 enum FieldNumber
 {
@@ -105,6 +122,22 @@ public:
     int m_iValue; ///< Value of the pair.
 };
 
+//! Pixels of a sprite, to find sprites that are a mirror image of another sprite.
+class SpritePixels
+{
+public:
+    SpritePixels();
+
+    SpritePixels Mirror(bool bHorizontal, bool bVertical) const;
+
+    int m_iWidth;  ///< Width of the sprite.
+    int m_iHeight; ///< Height of the sprite.
+    std::vector<unsigned int> m_vPixels; ///< Two values for each pixel in horizontal rows, the colour,
+                                         ///< and the recolour table (0 means no recolouring, else 256 + table).
+};
+
+bool operator<(const SpritePixels &sp1, const SpritePixels &sp2);
+
 //! An element (a sprite) in a frame.
 class FrameElement
 {
@@ -117,7 +150,7 @@ public:
     void SetProperties(const std::vector<FieldStorage> &fields);
 
     void Check();
-    bool WriteSprite(Output *pOut, int *iXoffset, int *iYoffset) const;
+    bool WriteSprite(Output *pOut, int *iXoffset, int *iYoffset, SpritePixels *pPixels = NULL, RunEnds *pEnds = NULL) const;
 
     int m_iLine;                  ///< Line number of the frame element.
 
@@ -189,6 +222,24 @@ public:
     std::vector<AnimationFrame> m_vFrames; ///< Frames of the animation.
 };
 
+//! A sprite with a number, outside the animations (for example a ground tile).
+class NumberedSprite
+{
+public:
+    NumberedSprite();
+    NumberedSprite(int line, int number);
+    NumberedSprite(const NumberedSprite &ns);
+    NumberedSprite &operator=(const NumberedSprite &ns);
+
+    void SetProperties(const std::vector<FieldStorage> &fields);
+
+    void Check();
+
+    int m_iLine;             ///< Line number defining the sprite.
+    int m_iNumber;           ///< Number of the sprite in the sprite table.
+    FrameElement m_oElement; ///< Images and placement of the sprite.
+};
+
 //! An animation with a name, a tile size, and 1 to 4 viewing directions.
 class AnimationGroup
 {
@@ -239,9 +290,13 @@ typedef std::vector<AnimationFrame>::const_iterator FrameConstIterator;
 typedef std::vector<Animation>::iterator AnimationIterator;
 typedef std::vector<Animation>::const_iterator AnimationConstIterator;
 
+typedef std::vector<NumberedSprite>::iterator NumberedSpriteIterator;
+
 typedef std::map<AnimationGroupKey, AnimationGroup>::iterator GroupIterator;
+typedef std::map<int, const NumberedSprite *>::const_iterator SpriteTableIterator;
 
 extern std::map<AnimationGroupKey, AnimationGroup> g_mapAnimGroups;
+extern std::map<int, const NumberedSprite *> g_mapSpriteTable;
 
 #endif
 
@@ -0,0 +1,239 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file atlas.cpp Packing of sprites into atlas images.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include "atlas.h"
+
+//! Sprite to pack, ordered by group, and decreasing height and width.
+class PackItem
+{
+public:
+    int m_iIndex;  ///< Index of the sprite.
+    int m_iGroup;  ///< Group of the sprite.
+    int m_iWidth;  ///< Width of the sprite, including padding.
+    int m_iHeight; ///< Height of the sprite, including padding.
+};
+
+//! Order of packing the sprites, by group, and tallest sprites first in a group.
+/*!
+    @param pi1 First sprite to compare.
+    @param pi2 Second sprite to compare.
+    @return \c true iff the first sprite should be packed before the second sprite.
+ */
+static bool operator<(const PackItem &pi1, const PackItem &pi2)
+{
+    if (pi1.m_iGroup != pi2.m_iGroup)
+        return pi1.m_iGroup < pi2.m_iGroup;
+    if (pi1.m_iHeight != pi2.m_iHeight)
+        return pi1.m_iHeight > pi2.m_iHeight;
+    if (pi1.m_iWidth != pi2.m_iWidth)
+        return pi1.m_iWidth > pi2.m_iWidth;
+    return pi1.m_iIndex < pi2.m_iIndex; // Keep packing deterministic.
+}
+
+//! Horizontal strip of an atlas, filled with sprites from left to right.
+class Shelf
+{
+public:
+    int m_iY;      ///< Top edge of the shelf.
+    int m_iHeight; ///< Height of the shelf.
+    int m_iUsed;   ///< Number of used columns of the shelf.
+};
+
+//! Get the smallest power of two that is at least \a iValue.
+/*!
+    @param iValue Value to round up.
+    @return The power of two.
+ */
+static int RoundUpPowerOfTwo(int iValue)
+{
+    int iPower = 1;
+    while (iPower < iValue)
+        iPower *= 2;
+    return iPower;
+}
+
+AtlasRect::AtlasRect()
+{
+    m_iAtlas = -1;
+    m_iX = 0;
+    m_iY = 0;
+    m_iWidth = 0;
+    m_iHeight = 0;
+}
+
+SpriteAtlas::SpriteAtlas(int iMaxSize, int iPadding)
+{
+    m_iMaxSize = iMaxSize;
+    m_iPadding = iPadding;
+}
+
+SpriteAtlas::~SpriteAtlas()
+{
+    for (size_t i = 0; i < m_vAtlas.size(); i++)
+        delete m_vAtlas[i];
+}
+
+//! Pack the sprites into atlas images, filling #m_vRects and #m_vAtlas.
+/*!
+    Sprites are packed onto shelves, tallest sprites first. A sprite goes onto
+    the first shelf with enough space left, or a new shelf if there is none. If
+    the atlas is full, a new atlas is started.
+    Sprites of a group are packed together. A group that does not fit in the
+    remaining space of an atlas starts in a new atlas, so that sprites drawn
+    together (such as the sprites of an animation) share an atlas if possible.
+    @param vSprites Sprites to pack.
+    @param vGroups Group of each sprite, empty means all sprites are in one group.
+ */
+void SpriteAtlas::Pack(const std::vector<const DecodedSprite *> &vSprites, const std::vector<int> &vGroups)
+{
+    std::vector<PackItem> vItems(vSprites.size());
+    int iArea = 0;
+    int iMaxWidth = 1;
+    for (size_t i = 0; i < vSprites.size(); i++)
+    {
+        vItems[i].m_iIndex = i;
+        vItems[i].m_iGroup = vGroups.empty() ? 0 : vGroups[i];
+        vItems[i].m_iWidth = vSprites[i]->iWidth + 2 * m_iPadding;
+        vItems[i].m_iHeight = vSprites[i]->iHeight + 2 * m_iPadding;
+        if (vItems[i].m_iWidth > m_iMaxSize || vItems[i].m_iHeight > m_iMaxSize)
+        {
+            fprintf(stderr, "Sprite of %dx%d pixels does not fit in an atlas of %dx%d pixels\n",
+                    vSprites[i]->iWidth, vSprites[i]->iHeight, m_iMaxSize, m_iMaxSize);
+            exit(1);
+        }
+        iArea += vItems[i].m_iWidth * vItems[i].m_iHeight;
+        iMaxWidth = std::max(iMaxWidth, vItems[i].m_iWidth);
+    }
+    std::sort(vItems.begin(), vItems.end());
+
+    // Aim for a square atlas.
+    int iAtlasWidth = RoundUpPowerOfTwo(std::max(iMaxWidth, (int)sqrt((double)iArea)));
+    if (iAtlasWidth > m_iMaxSize)
+        iAtlasWidth = m_iMaxSize;
+
+    m_vRects.assign(vSprites.size(), AtlasRect());
+    std::vector<int> vHeights; // Used height of each atlas.
+    std::vector<Shelf> vShelves;
+    for (size_t i = 0; i < vItems.size(); i++)
+    {
+        const PackItem &item = vItems[i];
+        if (!vHeights.empty() && item.m_iGroup != vItems[i - 1].m_iGroup)
+        {
+            // Start a new atlas if the area of the group is more than the remaining area.
+            int iGroupArea = 0;
+            for (size_t j = i; j < vItems.size() && vItems[j].m_iGroup == item.m_iGroup; j++)
+                iGroupArea += vItems[j].m_iWidth * vItems[j].m_iHeight;
+            if (iGroupArea > iAtlasWidth * (m_iMaxSize - vHeights.back()) && iGroupArea <= iAtlasWidth * m_iMaxSize)
+                vShelves.clear();
+        }
+
+        // A shelf of an earlier group may be lower than the sprite.
+        size_t iShelf = 0;
+        while (iShelf < vShelves.size() && (vShelves[iShelf].m_iUsed + item.m_iWidth > iAtlasWidth
+                                            || vShelves[iShelf].m_iHeight < item.m_iHeight))
+            iShelf++;
+
+        if (iShelf == vShelves.size())
+        {
+            Shelf shelf;
+            shelf.m_iY = vShelves.empty() ? 0 : vShelves.back().m_iY + vShelves.back().m_iHeight;
+            shelf.m_iHeight = item.m_iHeight;
+            shelf.m_iUsed = 0;
+            if (vShelves.empty() || shelf.m_iY + shelf.m_iHeight > m_iMaxSize)
+            {
+                // Start a new atlas.
+                vHeights.push_back(0);
+                vShelves.clear();
+                iShelf = 0;
+                shelf.m_iY = 0;
+            }
+            vShelves.push_back(shelf);
+        }
+
+        AtlasRect &rect = m_vRects[item.m_iIndex];
+        rect.m_iAtlas = vHeights.size() - 1;
+        rect.m_iX = vShelves[iShelf].m_iUsed + m_iPadding;
+        rect.m_iY = vShelves[iShelf].m_iY + m_iPadding;
+        rect.m_iWidth = item.m_iWidth - 2 * m_iPadding;
+        rect.m_iHeight = item.m_iHeight - 2 * m_iPadding;
+        vShelves[iShelf].m_iUsed += item.m_iWidth;
+        vHeights.back() = std::max(vHeights.back(), vShelves[iShelf].m_iY + item.m_iHeight);
+    }
+
+    // Copy the sprites into the atlas images.
+    for (size_t i = 0; i < m_vAtlas.size(); i++)
+        delete m_vAtlas[i];
+    m_vAtlas.clear();
+    for (size_t i = 0; i < vHeights.size(); i++)
+    {
+        Image32bpp *pAtlas = new Image32bpp(iAtlasWidth, RoundUpPowerOfTwo(vHeights[i]));
+        memset(pAtlas->pData, 0, sizeof(uint32) * pAtlas->iWidth * pAtlas->iHeight);
+        m_vAtlas.push_back(pAtlas);
+    }
+    for (size_t i = 0; i < vSprites.size(); i++)
+    {
+        const AtlasRect &rect = m_vRects[i];
+        Image32bpp *pAtlas = m_vAtlas[rect.m_iAtlas];
+        assert(rect.m_iX + rect.m_iWidth <= pAtlas->iWidth && rect.m_iY + rect.m_iHeight <= pAtlas->iHeight);
+        for (int y = 0; y < rect.m_iHeight; y++)
+        {
+            memcpy(pAtlas->pData + (rect.m_iY + y) * pAtlas->iWidth + rect.m_iX,
+                   vSprites[i]->pData + y * rect.m_iWidth, sizeof(uint32) * rect.m_iWidth);
+        }
+    }
+}
+
+//! Get the name of the file of an atlas image.
+/*!
+    @param sPrefix Start of the filename.
+    @param iAtlas Number of the atlas.
+    @param bRaw Whether the image is written as raw RGBA pixels.
+    @return Name of the file.
+ */
+std::string SpriteAtlas::GetFilename(const std::string &sPrefix, int iAtlas, bool bRaw) const
+{
+    char sNumber[16];
+    sprintf(sNumber, "-%d.", iAtlas);
+    return sPrefix + sNumber + (bRaw ? "rgba" : "png");
+}
+
+//! Write the atlas images.
+/*!
+    @param sPrefix Start of the filenames, the number of the atlas and the extension are added.
+    @param bRaw Write the raw RGBA pixels instead of PNG files.
+ */
+void SpriteAtlas::Write(const std::string &sPrefix, bool bRaw) const
+{
+    for (size_t i = 0; i < m_vAtlas.size(); i++)
+        Save32Bpp(GetFilename(sPrefix, i, bRaw), *m_vAtlas[i], bRaw);
+}
+
+// vim: et sw=4 ts=4 sts=4
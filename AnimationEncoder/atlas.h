@@ -0,0 +1,70 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file atlas.h Packing of sprites into atlas images.
+
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <string>
+#include <vector>
+#include "decoder.h"
+
+//! Position of a sprite in an atlas image.
+class AtlasRect
+{
+public:
+    AtlasRect();
+
+    int m_iAtlas;  ///< Number of the atlas image containing the sprite.
+    int m_iX;      ///< Left edge of the sprite in the atlas.
+    int m_iY;      ///< Top edge of the sprite in the atlas.
+    int m_iWidth;  ///< Width of the sprite.
+    int m_iHeight; ///< Height of the sprite.
+};
+
+//! Atlas images with sprites packed into them.
+class SpriteAtlas
+{
+public:
+    //! Constructor.
+    /*!
+        @param iMaxSize Maximal width and height of an atlas image.
+        @param iPadding Number of transparent pixels around each sprite.
+     */
+    SpriteAtlas(int iMaxSize, int iPadding);
+    ~SpriteAtlas();
+
+    void Pack(const std::vector<const DecodedSprite *> &vSprites, const std::vector<int> &vGroups);
+    void Write(const std::string &sPrefix, bool bRaw) const;
+    std::string GetFilename(const std::string &sPrefix, int iAtlas, bool bRaw) const;
+
+    int m_iMaxSize;                     ///< Maximal width and height of an atlas image.
+    int m_iPadding;                     ///< Number of transparent pixels around each sprite.
+    std::vector<AtlasRect> m_vRects;    ///< Position of each packed sprite.
+    std::vector<Image32bpp *> m_vAtlas; ///< Atlas images.
+};
+
+#endif
+
+// vim: et sw=4 ts=4 sts=4
@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+# Copyright (c) 2013- Albert "Alberth" Hofkamp
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""
+Benchmark of decoding the image file formats of the encoder.
+
+Usage: python3 decode_bench.py [runs]
+
+Builds 60 sprite sheets of 1200x800 RGBA pixels, by repeating the ground tiles
+1 to 60, and writes each sheet as .png, .qoi and raw file. An animation file
+for each format takes one sprite from every sheet, so every sheet is decoded
+once. The median wall time of the encoder over the runs is printed for each
+format, with the total size of the sheets. The output must be the same for all
+formats.
+
+The plant sprites of plant_anim.txt are not part of the benchmark, their
+images (xuxo_graphics) are not in the repository.
+"""
+
+import os, shutil, struct, subprocess, sys, tempfile, time, zlib
+
+SHEET_WIDTH = 1200
+SHEET_HEIGHT = 800
+SHEETS = 60
+
+
+def read_png(path):
+    """Read an 8 bit RGBA .png file, return (width, height, rows)."""
+    data = open(path, 'rb').read()
+    pos = 8
+    idat = b''
+    header = None
+    while pos < len(data):
+        length, = struct.unpack('>I', data[pos:pos + 4])
+        kind = data[pos + 4:pos + 8]
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            header = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'IDAT':
+            idat += chunk
+    width, height, depth, colour = header[:4]
+    if depth != 8 or colour != 6 or header[6] != 0:
+        sys.exit('%s is not a non-interlaced 8 bit RGBA .png file' % path)
+
+    raw = zlib.decompress(idat)
+    stride = width * 4
+    rows = []
+    prev = bytearray(stride)
+    i = 0
+    for y in range(height):
+        kind = raw[i]
+        line = bytearray(raw[i + 1:i + 1 + stride])
+        i += 1 + stride
+        for x in range(stride):
+            a = line[x - 4] if x >= 4 else 0
+            b = prev[x]
+            c = prev[x - 4] if x >= 4 else 0
+            if kind == 1:
+                line[x] = (line[x] + a) & 255
+            elif kind == 2:
+                line[x] = (line[x] + b) & 255
+            elif kind == 3:
+                line[x] = (line[x] + (a + b) // 2) & 255
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                line[x] = (line[x] + (a if pa <= pb and pa <= pc else (b if pb <= pc else c))) & 255
+        rows.append(bytes(line))
+        prev = line
+    return width, height, rows
+
+
+def write_png(path, width, height, rows):
+    """Write RGBA rows as .png file, with the 'sub' filter on each row."""
+    raw = bytearray()
+    for row in rows:
+        raw.append(1)
+        raw += row[:4]
+        raw += bytes((row[x] - row[x - 4]) & 255 for x in range(4, len(row)))
+
+    def chunk(kind, data):
+        return struct.pack('>I', len(data)) + kind + data + struct.pack('>I', zlib.crc32(kind + data) & 0xFFFFFFFF)
+
+    with open(path, 'wb') as f:
+        f.write(b'\x89PNG\r\n\x1a\n')
+        f.write(chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 6, 0, 0, 0)))
+        f.write(chunk(b'IDAT', zlib.compress(bytes(raw), 9)))
+        f.write(chunk(b'IEND', b''))
+
+
+def write_qoi(path, width, height, rows):
+    """Write RGBA rows as .qoi file."""
+    out = bytearray(b'qoif' + struct.pack('>II', width, height) + bytes([4, 0]))
+    index = [(0, 0, 0, 0)] * 64
+    prev = (0, 0, 0, 255)
+    run = 0
+    pixels = b''.join(rows)
+    count = width * height
+    for i in range(count):
+        px = tuple(pixels[4 * i:4 * i + 4])
+        if px == prev:
+            run += 1
+            if run == 62 or i == count - 1:
+                out.append(0xC0 | (run - 1))
+                run = 0
+            continue
+        if run > 0:
+            out.append(0xC0 | (run - 1))
+            run = 0
+        pos = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64
+        if index[pos] == px:
+            out.append(pos)
+        else:
+            index[pos] = px
+            if px[3] == prev[3]:
+                dr = (px[0] - prev[0] + 128) % 256 - 128
+                dg = (px[1] - prev[1] + 128) % 256 - 128
+                db = (px[2] - prev[2] + 128) % 256 - 128
+                if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                    out.append(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))
+                elif -32 <= dg <= 31 and -8 <= dr - dg <= 7 and -8 <= db - dg <= 7:
+                    out.append(0x80 | (dg + 32))
+                    out.append(((dr - dg + 8) << 4) | (db - dg + 8))
+                else:
+                    out += bytes([0xFE, px[0], px[1], px[2]])
+            else:
+                out += bytes([0xFF, px[0], px[1], px[2], px[3]])
+        prev = px
+    out += bytes([0, 0, 0, 0, 0, 0, 0, 1])
+    open(path, 'wb').write(bytes(out))
+
+
+def write_raw(path, width, height, rows):
+    """Write RGBA rows as raw image file of the encoder."""
+    with open(path, 'wb') as f:
+        f.write(b'CTRI' + struct.pack('<II', width, height) + bytes([4, 0, 0, 0]))
+        for row in rows:
+            f.write(row)
+
+
+def main():
+    runs = int(sys.argv[1]) if len(sys.argv) > 1 else 5
+    top = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    encoder = os.path.join(top, 'AnimationEncoder', 'encoder')
+    if not os.access(encoder, os.X_OK):
+        sys.exit("Encoder not found, run 'make' first")
+
+    work = tempfile.mkdtemp(prefix='decode_bench.')
+    try:
+        formats = [('png', write_png), ('qoi', write_qoi), ('raw', write_raw)]
+        for i in range(1, SHEETS + 1):
+            width, height, tile = read_png(os.path.join(top, 'ground_tiles', 's%d.png' % i))
+            rows = []
+            for y in range(SHEET_HEIGHT):
+                row = tile[y % height] * (SHEET_WIDTH // width + 1)
+                rows.append(row[:SHEET_WIDTH * 4])
+            for ext, write in formats:
+                write(os.path.join(work, 'sheet%d.%s' % (i, ext)), SHEET_WIDTH, SHEET_HEIGHT, rows)
+
+        print('format  sheet bytes  median ms')
+        reference = None
+        for ext, write in formats:
+            spec = os.path.join(work, 'bench_%s.txt' % ext)
+            with open(spec, 'w') as f:
+                for i in range(1, SHEETS + 1):
+                    f.write('animation "sheet%d" {\n    view = north;\n    frame {\n' % i)
+                    f.write('        element { base = "%s"; left = 0; top = 0; width = 64; height = 32;'
+                            ' x_offset = -32; y_offset = -16; }\n' % os.path.join(work, 'sheet%d.%s' % (i, ext)))
+                    f.write('    }\n}\n\n')
+
+            times = []
+            for r in range(runs):
+                start = time.time()
+                subprocess.check_call([encoder, spec, os.path.join(work, 'out.bin')], stdout=subprocess.DEVNULL)
+                times.append((time.time() - start) * 1000.0)
+            times.sort()
+            size = sum(os.path.getsize(os.path.join(work, 'sheet%d.%s' % (i, ext))) for i in range(1, SHEETS + 1))
+            print('%-6s %12d %10.1f' % (ext, size, times[len(times) // 2]))
+
+            output = open(os.path.join(work, 'out.bin'), 'rb').read()
+            if reference is None:
+                reference = output
+            elif output != reference:
+                sys.exit('Output from the %s files differs from the output of the png files' % ext)
+    finally:
+        shutil.rmtree(work)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: et sw=4 ts=4 sts=4
@@ -0,0 +1,305 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file decoder.cpp Reference decoder of sprite blocks, for checking the generated output.
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "ast.h"
+#include "decoder.h"
+
+DecodedSprite::DecodedSprite(int iWidth, int iHeight)
+{
+    this->iWidth = iWidth;
+    this->iHeight = iHeight;
+    pData = (uint32 *)malloc(sizeof(uint32) * iWidth * iHeight);
+    pLayers = (int *)malloc(sizeof(int) * iWidth * iHeight);
+}
+
+DecodedSprite::~DecodedSprite()
+{
+    free(pData);
+    free(pLayers);
+}
+
+SpriteLayout::SpriteLayout()
+{
+    for (int i = 0; i < RT_COUNT; i++)
+    {
+        m_aRuns[i] = 0;
+        m_aPixels[i] = 0;
+        m_aHeaderBytes[i] = 0;
+        m_aPayloadBytes[i] = 0;
+    }
+    m_iBlockBytes = 0;
+}
+
+//! Read a 16 bit unsigned number.
+/*!
+    @param pData Start of the number.
+    @return The value of the number.
+ */
+static int Read16(const uint8 *pData)
+{
+    return pData[0] | (pData[1] << 8);
+}
+
+//! Read a 32 bit unsigned number.
+/*!
+    @param pData Start of the number.
+    @return The value of the number.
+ */
+static uint32 Read32(const uint8 *pData)
+{
+    uint32 iValue = pData[3];
+    iValue = (iValue << 8) | pData[2];
+    iValue = (iValue << 8) | pData[1];
+    iValue = (iValue << 8) | pData[0];
+    return iValue;
+}
+
+//! Read a number written in groups of 7 bits, least significant group first.
+/*!
+    @param [inout] pData Start of the number, updated to the first byte after the number.
+    @param pEnd End of the available data.
+    @param [out] pValue Value of the number.
+    @return Whether a number could be read.
+ */
+static bool ReadVarint(const uint8 **pData, const uint8 *pEnd, uint32 *pValue)
+{
+    uint32 iValue = 0;
+    for (int iShift = 0; iShift < 32; iShift += 7)
+    {
+        if (*pData >= pEnd) return false;
+        uint8 iByte = *(*pData)++;
+        iValue |= (uint32)(iByte & 0x7F) << iShift;
+        if ((iByte & 0x80) == 0)
+        {
+            *pValue = iValue;
+            return true;
+        }
+    }
+    return false;
+}
+
+//! Read the colour of a pixel.
+/*!
+    @param [inout] pData Start of the colour, updated to the first byte after the colour.
+    @param pPalette Palette of the sprite, if the colours are stored as index.
+    @param iOpacity Opacity of the pixel.
+    @return The colour of the pixel.
+ */
+static uint32 ReadColour(const uint8 **pData, const uint8 *pPalette, uint8 iOpacity)
+{
+    const uint8 *pRgb = *pData;
+    if (pPalette != NULL)
+    {
+        pRgb = pPalette + 3 * **pData;
+        *pData += 1;
+    }
+    else
+    {
+        *pData += 3;
+    }
+    return MakeRGBA(pRgb[0], pRgb[1], pRgb[2], iOpacity);
+}
+
+//! Store a decoded pixel, if it is in the requested area.
+/*!
+    @param pSprite Decoded sprite.
+    @param iFirst Index of the first pixel of the decoded area in the sprite.
+    @param iCount Index of the pixel in the sprite.
+    @param iColour Colour of the pixel.
+    @param iLayer Recolour table of the pixel, \c -1 if not recoloured.
+ */
+static void StorePixel(DecodedSprite *pSprite, int iFirst, int iCount, uint32 iColour, int iLayer)
+{
+    int iOffset = iCount - iFirst;
+    if (iOffset < 0 || iOffset >= pSprite->iWidth * pSprite->iHeight) return;
+
+    pSprite->pData[iOffset] = iColour;
+    pSprite->pLayers[iOffset] = iLayer;
+}
+
+DecodedSprite *DecodeSprite(const uint8 *pBlock, int iSize, int iFirstRow, int iNumRows, SpriteLayout *pLayout)
+{
+    if (iSize < SPRITE_NON_DATA_SIZE || pBlock[0] != 'S') return NULL;
+    if (pBlock[1] != 'P' && pBlock[1] != 'X') return NULL;
+
+    const int iWidth = Read16(pBlock + 2);
+    const int iHeight = Read16(pBlock + 4);
+    if (Read32(pBlock + 6) != (uint32)(iSize - SPRITE_NON_DATA_SIZE)) return NULL;
+
+    const uint8 *pEnd = pBlock + iSize;
+    const uint8 *pData = pBlock + SPRITE_NON_DATA_SIZE;
+    const uint8 *pRowTable = NULL;
+    const uint8 *pPalette = NULL;
+    uint8 aPalette[256 * 3];
+    if (pBlock[1] == 'X')
+    {
+        if (pData + 2 > pEnd) return NULL;
+        int iFlags = Read16(pData);
+        pData += 2;
+        if ((iFlags & ~(SPF_ROW_TABLE | SPF_PALETTE)) != 0) return NULL; // Unknown flags.
+
+        if ((iFlags & SPF_ROW_TABLE) != 0)
+        {
+            pRowTable = pData;
+            pData += 4 * iHeight;
+            if (pData > pEnd) return NULL;
+        }
+        if ((iFlags & SPF_PALETTE) != 0)
+        {
+            if (pData >= pEnd) return NULL;
+            int iColours = *pData++ + 1;
+            if (pData + 3 * iColours > pEnd) return NULL;
+
+            memset(aPalette, 0, sizeof(aPalette));
+            memcpy(aPalette, pData, 3 * iColours);
+            pData += 3 * iColours;
+            pPalette = aPalette;
+        }
+    }
+    const uint32 iColourSize = (pPalette != NULL) ? 1 : 3;
+
+    if (iNumRows < 0) iNumRows = iHeight - iFirstRow;
+    if (iFirstRow < 0 || iNumRows < 0 || iFirstRow + iNumRows > iHeight) return NULL;
+
+    const int iFirst = iFirstRow * iWidth;       // First pixel to store.
+    const int iStop = iFirst + iNumRows * iWidth; // Pixel after the last pixel to store.
+    const uint8 *pStream = pData;
+    int iCount = 0;
+    if (pRowTable != NULL && iFirstRow < iHeight)
+    {
+        // Skip the rows before the requested area.
+        pData += Read32(pRowTable + 4 * iFirstRow);
+        iCount = iFirst;
+    }
+
+    if (pLayout != NULL)
+        pLayout->m_iBlockBytes += pStream - pBlock;
+
+    DecodedSprite *pSprite = new DecodedSprite(iWidth, iNumRows);
+    while (iCount < iStop)
+    {
+        const uint8 *pRun = pData; // Start of the run, for the layout.
+        RunType eType = RT_TRANSPARENT;
+        const uint8 *pPayload;     // Start of the pixel data of the run.
+
+        if (pRowTable != NULL && iCount % iWidth == 0
+                && pStream + Read32(pRowTable + 4 * (iCount / iWidth)) != pData)
+        {
+            break; // Row offset does not match with the data.
+        }
+
+        if (pData >= pEnd) break;
+        uint8 iHeader = *pData++;
+        uint32 iLength = iHeader & 63;
+        if (iLength == 0) // Extended length.
+        {
+            if (!ReadVarint(&pData, pEnd, &iLength) || iLength == 0) break;
+        }
+        if (iLength > (uint32)(iWidth * iHeight - iCount)) break;
+        if (pRowTable != NULL && iCount / iWidth != (int)(iCount + iLength - 1) / iWidth) break;
+
+        uint32 iRunLength = iLength;
+        if ((iHeader & 0xC0) == 0) // Fixed fully opaque 32bpp pixels (RGB).
+        {
+            eType = RT_OPAQUE;
+            pPayload = pData;
+            if (iColourSize * iLength > (uint32)(pEnd - pData)) break;
+            for (uint32 i = 0; i < iLength; i++)
+                StorePixel(pSprite, iFirst, iCount++, ReadColour(&pData, pPalette, OPAQUE), -1);
+        }
+        else if ((iHeader & 0xC0) == 64) // Partially transparent 32bpp pixels (RGB).
+        {
+            if (pData >= pEnd) break;
+            uint8 iOpacity = *pData++;
+            pPayload = pData;
+            if (iOpacity == RGBA_RUN_OPACITY) // Opacity for each pixel (RGBA).
+            {
+                eType = RT_RGBA;
+                if ((iColourSize + 1) * iLength > (uint32)(pEnd - pData)) break;
+                for (uint32 i = 0; i < iLength; i++)
+                {
+                    uint8 iAlpha = pData[iColourSize];
+                    StorePixel(pSprite, iFirst, iCount++, ReadColour(&pData, pPalette, iAlpha), -1);
+                    pData++;
+                }
+            }
+            else if (iOpacity == FILL_RUN_OPACITY) // Opaque pixels with a single colour.
+            {
+                eType = RT_FILL;
+                if (iColourSize > (uint32)(pEnd - pData)) break;
+                uint32 iColour = ReadColour(&pData, pPalette, OPAQUE);
+                for (uint32 i = 0; i < iLength; i++)
+                    StorePixel(pSprite, iFirst, iCount++, iColour, -1);
+            }
+            else
+            {
+                eType = RT_PARTIAL;
+                if (iColourSize * iLength > (uint32)(pEnd - pData)) break;
+                for (uint32 i = 0; i < iLength; i++)
+                    StorePixel(pSprite, iFirst, iCount++, ReadColour(&pData, pPalette, iOpacity), -1);
+            }
+        }
+        else if ((iHeader & 0xC0) == 128) // Fixed fully transparent pixels.
+        {
+            eType = RT_TRANSPARENT;
+            pPayload = pData;
+            for (uint32 i = 0; i < iLength; i++)
+                StorePixel(pSprite, iFirst, iCount++, MakeRGBA(0, 0, 0, TRANSPARENT), -1);
+        }
+        else // Recolour layer.
+        {
+            eType = RT_RECOLOUR;
+            if (2 + iLength > (uint32)(pEnd - pData)) break;
+            uint8 iTableNumber = *pData++;
+            uint8 iOpacity = *pData++;
+            pPayload = pData;
+            for (uint32 i = 0; i < iLength; i++)
+            {
+                StorePixel(pSprite, iFirst, iCount++, MakeRGBA(*pData, *pData, *pData, iOpacity), iTableNumber);
+                pData++;
+            }
+        }
+
+        if (pLayout != NULL)
+        {
+            pLayout->m_aRuns[eType]++;
+            pLayout->m_aPixels[eType] += iRunLength;
+            pLayout->m_aHeaderBytes[eType] += pPayload - pRun;
+            pLayout->m_aPayloadBytes[eType] += pData - pPayload;
+        }
+    }
+
+    if (iCount < iStop)
+    {
+        delete pSprite;
+        return NULL;
+    }
+    return pSprite;
+}
+
+// vim: et sw=4 ts=4 sts=4
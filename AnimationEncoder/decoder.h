@@ -0,0 +1,89 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file decoder.h Reference decoder of sprite blocks, for checking the generated output.
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include "image.h"
+
+//! Pixels of a decoded sprite.
+class DecodedSprite
+{
+public:
+    //! Constructor.
+    /*!
+        @param iWidth Width of the decoded area.
+        @param iHeight Height of the decoded area.
+    */
+    DecodedSprite(int iWidth, int iHeight);
+    ~DecodedSprite();
+
+    int iWidth;    ///< Width of the decoded area in pixels.
+    int iHeight;   ///< Height of the decoded area in pixels.
+    uint32 *pData; ///< Decoded pixels, in horizontal rows, encoded using #MakeRGBA.
+                   ///< Recoloured pixels have their table index in all colour channels.
+    int *pLayers;  ///< Recolour table of each pixel, \c -1 means the pixel is not recoloured.
+};
+
+//! Types of runs of pixels in a sprite block.
+enum RunType
+{
+    RT_OPAQUE,      ///< Fully opaque pixels.
+    RT_PARTIAL,     ///< Pixels with a single partial opacity.
+    RT_RGBA,        ///< Pixels with an opacity for each pixel.
+    RT_FILL,        ///< Fully opaque pixels with a single colour.
+    RT_TRANSPARENT, ///< Fully transparent pixels.
+    RT_RECOLOUR,    ///< Recoloured pixels.
+
+    RT_COUNT        ///< Number of run types.
+};
+
+//! Sizes of the parts of a sprite block, found while decoding it.
+class SpriteLayout
+{
+public:
+    SpriteLayout();
+
+    int m_aRuns[RT_COUNT];         ///< Number of runs of each type.
+    int m_aPixels[RT_COUNT];       ///< Number of pixels in the runs of each type.
+    int m_aHeaderBytes[RT_COUNT];  ///< Bytes of the run headers (type, length, opacity, table) of each type.
+    int m_aPayloadBytes[RT_COUNT]; ///< Bytes of the pixel data of the runs of each type.
+    int m_iBlockBytes;             ///< Bytes of the block header, flags, row table, and palette.
+};
+
+//! Decode (some rows of) a sprite block.
+/*!
+    @param pBlock Start of the sprite block.
+    @param iSize Size of the sprite block in bytes.
+    @param iFirstRow First row of the sprite to decode.
+    @param iNumRows Number of rows to decode, \c -1 means all remaining rows.
+    @param [out] pLayout If not \c NULL, sizes of the parts of the decoded rows are added to it.
+    @return The decoded rows, or \c NULL if the block is not valid.
+ */
+DecodedSprite *DecodeSprite(const uint8 *pBlock, int iSize, int iFirstRow, int iNumRows, SpriteLayout *pLayout = NULL);
+
+#endif
+
+// vim: et sw=4 ts=4 sts=4
@@ -0,0 +1,194 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file filedata.cpp Access to the contents of input files.
+
+#include <cstdio>
+#include <cstdlib>
+#include "filedata.h"
+#include "prefetch.h"
+#include "storage.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static const int FILE_DATA_CACHE_SIZE = 8; ///< Number of kept files.
+
+//! Read the contents of a file.
+/*!
+    The file is mapped into memory if possible (and not disabled with \c --no-mmap), with a
+    hint how it is read. Else (or on systems without \c mmap) the file is read into allocated memory.
+    @param sFilename Name of the file to read.
+    @param bSequential Whether the file is read from start to end (else only the accessed parts are read).
+ */
+FileData::FileData(const std::string &sFilename, bool bSequential)
+{
+    m_sFilename = sFilename;
+    m_pData = NULL;
+    m_iSize = 0;
+    m_bOpen = false;
+    m_bMapped = false;
+
+#ifndef _WIN32
+    int iFd = open(sFilename.c_str(), O_RDONLY);
+    if (iFd < 0)
+        return;
+
+    struct stat oStat;
+    if (fstat(iFd, &oStat) == 0 && S_ISREG(oStat.st_mode))
+    {
+        m_bOpen = true;
+        m_iSize = oStat.st_size;
+        if (m_iSize > 0 && g_oSettings.m_bMapFiles)
+        {
+            void *pMapping = mmap(NULL, m_iSize, PROT_READ, MAP_PRIVATE, iFd, 0);
+            if (pMapping != MAP_FAILED)
+            {
+                madvise(pMapping, m_iSize, bSequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+                m_pData = static_cast<const unsigned char *>(pMapping);
+                m_bMapped = true;
+            }
+        }
+    }
+    close(iFd);
+    if (m_bMapped || (m_bOpen && m_iSize == 0))
+        return;
+    m_bOpen = false;
+    m_iSize = 0; // Counts the read bytes below.
+#endif
+
+    // Read the file into memory.
+    FILE *pFile = fopen(sFilename.c_str(), "rb");
+    if (pFile == NULL)
+        return;
+
+    size_t iAllocated = 0;
+    unsigned char *pData = NULL;
+    for (;;)
+    {
+        if (m_iSize == iAllocated)
+        {
+            iAllocated = (iAllocated == 0) ? 65536 : 2 * iAllocated;
+            pData = static_cast<unsigned char *>(realloc(pData, iAllocated));
+            if (pData == NULL)
+            {
+                fprintf(stderr, "Out of memory while reading \"%s\".\n", sFilename.c_str());
+                exit(1);
+            }
+        }
+        size_t iRead = fread(pData + m_iSize, 1, iAllocated - m_iSize, pFile);
+        if (iRead == 0)
+            break;
+        m_iSize += iRead;
+    }
+    m_bOpen = !ferror(pFile);
+    fclose(pFile);
+    m_pData = pData;
+}
+
+FileData::~FileData()
+{
+#ifndef _WIN32
+    if (m_bMapped)
+    {
+        munmap(const_cast<unsigned char *>(m_pData), m_iSize);
+        return;
+    }
+#endif
+    free(const_cast<unsigned char *>(m_pData));
+}
+
+//! Whether the file could be read.
+/*!
+    @return The file could be read, and \a m_pData and \a m_iSize are its contents.
+ */
+bool FileData::IsOpen() const
+{
+    return m_bOpen;
+}
+
+//! Recently used files, so a file used several times in a row is read only once.
+class FileDataCache
+{
+public:
+    FileDataCache()
+    {
+        for (int i = 0; i < FILE_DATA_CACHE_SIZE; i++)
+            m_aFiles[i] = NULL;
+    }
+
+    ~FileDataCache()
+    {
+        for (int i = 0; i < FILE_DATA_CACHE_SIZE; i++)
+            delete m_aFiles[i];
+    }
+
+    const FileData *Get(const std::string &sFilename);
+
+private:
+    FileData *m_aFiles[FILE_DATA_CACHE_SIZE]; ///< Read files (if not \c NULL), most recently used first.
+};
+
+static FileDataCache g_oFileDataCache; ///< Recently used files.
+
+const FileData *FileDataCache::Get(const std::string &sFilename)
+{
+    int iFound = FILE_DATA_CACHE_SIZE - 1; // Re-use the least recently used entry if not found.
+    for (int i = 0; i < FILE_DATA_CACHE_SIZE; i++)
+    {
+        if (m_aFiles[i] != NULL && m_aFiles[i]->m_sFilename == sFilename)
+        {
+            iFound = i;
+            break;
+        }
+    }
+
+    FileData *pFile = m_aFiles[iFound];
+    for (int i = iFound; i > 0; i--)
+        m_aFiles[i] = m_aFiles[i - 1];
+
+    if (pFile == NULL || pFile->m_sFilename != sFilename)
+    {
+        delete pFile;
+        PrefetchUsed(sFilename);
+        pFile = new FileData(sFilename);
+    }
+    m_aFiles[0] = pFile;
+    return pFile->IsOpen() ? pFile : NULL;
+}
+
+//! Get the contents of a file, sharing them with earlier requests for the same file.
+/*!
+    @param sFilename Name of the file.
+    @return The contents of the file, valid until the next call, or \c NULL if the file could not be read.
+ */
+const FileData *GetFileData(const std::string &sFilename)
+{
+    return g_oFileDataCache.Get(sFilename);
+}
+
+// vim: et sw=4 ts=4 sts=4
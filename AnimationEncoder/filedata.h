@@ -0,0 +1,56 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file filedata.h Access to the contents of input files.
+
+#ifndef FILEDATA_H
+#define FILEDATA_H
+
+#include <string>
+#include <cstddef>
+
+//! Contents of an input file, memory mapped where the system supports it.
+class FileData
+{
+public:
+    FileData(const std::string &sFilename, bool bSequential = true);
+    ~FileData();
+
+    bool IsOpen() const;
+
+    std::string m_sFilename;      ///< Name of the file.
+    const unsigned char *m_pData; ///< Contents of the file (\c NULL if the file could not be read, or is empty).
+    size_t m_iSize;               ///< Number of bytes in the file.
+    bool m_bOpen;                 ///< Whether the file could be read.
+    bool m_bMapped;               ///< Whether \a m_pData is a memory mapping (else it is allocated).
+
+private:
+    FileData(const FileData &);            // Not copyable, the contents are owned.
+    FileData &operator=(const FileData &);
+};
+
+const FileData *GetFileData(const std::string &sFilename);
+
+#endif
+
+// vim: et sw=4 ts=4 sts=4
@@ -26,8 +26,15 @@ SOFTWARE.
 #include <cassert>
 #include <cstring>
 #include <string>
+#include <map>
+#include <vector>
 #include <png.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "image.h"
+#include "imagefile.h"
+#include "trace.h"
 
 const int RGBA_CHANNELS_PER_PIXEL = 4;  ///< Number of colour channels in libpng for a single RGBA pixel.
 
@@ -70,24 +77,121 @@ uint8 GetG(uint32 rgba) { return (rgba >> PXENC_GREEN)   & PXENC_CHANNEL_MASK; }
 uint8 GetB(uint32 rgba) { return (rgba >> PXENC_BLUE)    & PXENC_CHANNEL_MASK; }
 uint8 GetA(uint32 rgba) { return (rgba >> PXENC_OPACITY) & PXENC_CHANNEL_MASK; }
 
+static const int POOL_CLASSES = 32;    ///< Number of size classes of the pixel buffer pool (powers of 2).
+static const size_t POOL_KEEP = 4;      ///< Number of free buffers kept for each size class.
+
+//! Pool of pixel buffers, to avoid allocating and releasing a buffer for every sprite.
+/*!
+    Buffers are allocated with a size that is a power of 2, released buffers are kept
+    for the next image of a similar size.
+ */
+class PixelPool
+{
+public:
+    ~PixelPool()
+    {
+        for (int i = 0; i < POOL_CLASSES; i++)
+        {
+            for (size_t j = 0; j < m_aFree[i].size(); j++)
+                free(m_aFree[i][j]);
+        }
+    }
+
+    //! Get a buffer.
+    /*!
+        @param iSize Number of bytes needed.
+        @return The buffer, release it with #Release.
+     */
+    void *Allocate(size_t iSize)
+    {
+        int iClass = GetClass(iSize);
+        if (!m_aFree[iClass].empty())
+        {
+            void *pBuffer = m_aFree[iClass].back();
+            m_aFree[iClass].pop_back();
+            return pBuffer;
+        }
+        void *pBuffer = malloc((size_t)1 << iClass);
+        if (pBuffer == NULL)
+        {
+            fprintf(stderr, "Out of memory while allocating %lu bytes for an image.\n", (unsigned long)iSize);
+            exit(1);
+        }
+        return pBuffer;
+    }
+
+    //! Release a buffer.
+    /*!
+        @param pBuffer Buffer from #Allocate (may be \c NULL).
+        @param iSize Number of bytes requested with #Allocate.
+     */
+    void Release(void *pBuffer, size_t iSize)
+    {
+        if (pBuffer == NULL)
+            return;
+
+        int iClass = GetClass(iSize);
+        if (m_aFree[iClass].size() < POOL_KEEP)
+            m_aFree[iClass].push_back(pBuffer);
+        else
+            free(pBuffer);
+    }
+
+private:
+    //! Get the size class of a buffer.
+    /*!
+        @param iSize Number of bytes needed.
+        @return Smallest \c n with \c 2**n at least \a iSize.
+     */
+    static int GetClass(size_t iSize)
+    {
+        int iClass = 0;
+        while (((size_t)1 << iClass) < iSize)
+            iClass++;
+        assert(iClass < POOL_CLASSES);
+        return iClass;
+    }
+
+    std::vector<void *> m_aFree[POOL_CLASSES]; ///< Free buffers of each size class.
+};
+
+static PixelPool g_oPixelPool; ///< Pool of the pixel buffers of the images.
+
 Image32bpp::Image32bpp(int iWidth, int iHeight)
 {
     this->iWidth = iWidth;
     this->iHeight = iHeight;
-    pData = (uint32 *)malloc(RGBA_CHANNELS_PER_PIXEL * iWidth * iHeight);
+    pData = (uint32 *)g_oPixelPool.Allocate(RGBA_CHANNELS_PER_PIXEL * iWidth * iHeight);
+    pOpacity = NULL;
 }
 
 Image32bpp::Image32bpp(const Image32bpp &img)
 {
     this->iWidth = img.iWidth;
     this->iHeight = img.iHeight;
-    pData = (uint32 *)malloc(RGBA_CHANNELS_PER_PIXEL * iWidth * iHeight);
+    pData = (uint32 *)g_oPixelPool.Allocate(RGBA_CHANNELS_PER_PIXEL * iWidth * iHeight);
     memcpy(pData, img.pData, RGBA_CHANNELS_PER_PIXEL * iWidth * iHeight);
+    pOpacity = NULL;
+    if (img.pOpacity != NULL)
+    {
+        pOpacity = (uint8 *)g_oPixelPool.Allocate(iWidth * iHeight);
+        memcpy(pOpacity, img.pOpacity, iWidth * iHeight);
+    }
 }
 
 Image32bpp::~Image32bpp()
 {
-    free(pData);
+    g_oPixelPool.Release(pData, RGBA_CHANNELS_PER_PIXEL * iWidth * iHeight);
+    g_oPixelPool.Release(pOpacity, iWidth * iHeight);
+}
+
+//! Store the opacity of the pixels as a separate plane, so it can be scanned without unpacking pixels.
+void Image32bpp::MakeOpacityPlane()
+{
+    if (pOpacity == NULL)
+        pOpacity = (uint8 *)g_oPixelPool.Allocate(iWidth * iHeight);
+    for (int i = 0; i < iWidth * iHeight; i++)
+        pOpacity[i] = GetA(pData[i]);
 }
 
 uint32 Image32bpp::Get(int offset) const
@@ -104,20 +208,20 @@ Image8bpp::Image8bpp(int iWidth, int iHeight)
 {
     this->iWidth = iWidth;
     this->iHeight = iHeight;
-    pData = (uint8 *)malloc(iWidth * iHeight);
+    pData = (uint8 *)g_oPixelPool.Allocate(iWidth * iHeight);
 }
 
 Image8bpp::Image8bpp(const Image8bpp &img)
 {
     this->iWidth = img.iWidth;
     this->iHeight = img.iHeight;
-    pData = (uint8 *)malloc(iWidth * iHeight);
+    pData = (uint8 *)g_oPixelPool.Allocate(iWidth * iHeight);
     memcpy(pData, img.pData, iWidth * iHeight);
 }
 
 Image8bpp::~Image8bpp()
 {
-    free(pData);
+    g_oPixelPool.Release(pData, iWidth * iHeight);
 }
 
 unsigned char Image8bpp::Get(int offset) const
@@ -129,85 +233,174 @@ unsigned char Image8bpp::Get(int offset) const
     return pData[offset];
 }
 
-//! Open an image (.png) file.
-/*!
-    @param sFilename Filename of the file to open.
-    @param [out] pngPtr Libpng data structure.
-    @param [out] infoPtr Libpng info structure.
-    @param [out] endInfo Libpng info structure.
-    @param [out] pRows Rows of pixel channel information, read from the file.
- */
-static void OpenFile(const std::string &sFilename, png_structp *pngPtr, png_infop *infoPtr, png_infop *endInfo, uint8 ***pRows)
+static const int IMAGE_CACHE_SIZE = 2; ///< Number of kept files, enough for a base image and its recolour image.
+
+//! Recently loaded image files, releasing them at the end of the program.
+class ImageCache
 {
-    const int PNG_SIGNATURE_SIZE = 4; // Number of bytes to read from the header for checking the given file is a PNG file.
+public:
+    ImageCache()
+    {
+        for (int i = 0; i < IMAGE_CACHE_SIZE; i++)
+            m_aFiles[i] = NULL;
+    }
 
-    FILE *pFile = fopen(sFilename.c_str(), "rb");
-    if(pFile == NULL)
+    ~ImageCache()
     {
-        fprintf(stderr, "PNG file \"%s\" could not be opened.\n", sFilename.c_str());
-        exit(1);
+        for (int i = 0; i < IMAGE_CACHE_SIZE; i++)
+            delete m_aFiles[i];
     }
 
-    unsigned char header[PNG_SIGNATURE_SIZE];
-    if(fread(header, 1, PNG_SIGNATURE_SIZE, pFile) != PNG_SIGNATURE_SIZE)
+    const LoadedImage &Get(const std::string &sFilename, ImagePixels eWanted);
+
+private:
+    LoadedImage *m_aFiles[IMAGE_CACHE_SIZE]; ///< Loaded files (if not \c NULL), most recently used first.
+};
+
+static ImageCache g_oImageCache; ///< Recently loaded image files.
+
+//! Get an image file, loading it only if it is not already loaded.
+/*!
+    Sprites are often cut from the same (sheet) file one after the other, keeping the
+    last loaded files avoids decoding such a file again for every sprite.
+    @param sFilename Filename of the file to get.
+    @param eWanted Wanted kind of pixels.
+    @return The loaded file, valid until the next call.
+ */
+const LoadedImage &ImageCache::Get(const std::string &sFilename, ImagePixels eWanted)
+{
+    int iFound = IMAGE_CACHE_SIZE - 1; // Re-use the least recently used entry if not found.
+    for (int i = 0; i < IMAGE_CACHE_SIZE; i++)
     {
-        fprintf(stderr, "Could not read header of \"%s\".\n", sFilename.c_str());
-        fclose(pFile);
-        exit(1);
+        if (m_aFiles[i] != NULL && m_aFiles[i]->m_sFilename == sFilename && m_aFiles[i]->m_eWanted == eWanted)
+        {
+            iFound = i;
+            break;
+        }
     }
-    bool bIsPng = !png_sig_cmp(header, 0, PNG_SIGNATURE_SIZE);
-    if(!bIsPng)
+
+    LoadedImage *pFile = m_aFiles[iFound];
+    for (int i = iFound; i > 0; i--)
+        m_aFiles[i] = m_aFiles[i - 1];
+
+    if (pFile == NULL || pFile->m_sFilename != sFilename || pFile->m_eWanted != eWanted)
     {
-        fprintf(stderr, "Header of \"%s\" indicates it is not a PNG file.\n", sFilename.c_str());
-        fclose(pFile);
-        exit(1);
+        delete pFile;
+        pFile = LoadImageFile(sFilename, eWanted);
     }
+    m_aFiles[0] = pFile;
+    return *pFile;
+}
+
+#ifdef __SSE2__
+//! Find the pixels that are not fully transparent among four pixels.
+/*!
+    @param pPixels Channels of the four pixels.
+    @return Bit mask of the visible pixels, bit \a n is set when pixel \a n is not fully transparent.
+ */
+static inline int GetVisibleMask(const uint8 *pPixels)
+{
+    __m128i oPixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pPixels));
+    // One bit for each channel that is zero, keep the bits of the opacity channels.
+    int iTransparent = _mm_movemask_epi8(_mm_cmpeq_epi8(oPixels, _mm_setzero_si128())) & 0x8888;
+    int iVisible = iTransparent ^ 0x8888;
+    return ((iVisible >> 3) & 1) | ((iVisible >> 6) & 2) | ((iVisible >> 9) & 4) | ((iVisible >> 12) & 8);
+}
+#endif
 
-    *pngPtr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    if (!*pngPtr)
+//! Find the first pixel in a row that is not fully transparent.
+/*!
+    With SSE2, pixels are tested four at a time.
+    @param pRow Row of pixel channels, as loaded from the .PNG file.
+    @param iFirst First column to test.
+    @param iEnd Column after the last column to test.
+    @return Column of the first pixel that is not fully transparent, or \a iEnd if there is none.
+ */
+static int FindFirstVisible(const uint8 *pRow, int iFirst, int iEnd)
+{
+    int x = iFirst;
+#ifdef __SSE2__
+    for (; x + 4 <= iEnd; x += 4)
     {
-        fprintf(stderr, "Could not initialize PNG data.\n");
-        fclose(pFile);
-        exit(1);
+        int iVisible = GetVisibleMask(pRow + x * RGBA_CHANNELS_PER_PIXEL);
+        if (iVisible != 0)
+        {
+            while ((iVisible & 1) == 0)
+            {
+                iVisible >>= 1;
+                x++;
+            }
+            return x;
+        }
     }
-    *infoPtr = png_create_info_struct(*pngPtr);
-    if(!*infoPtr)
+#endif
+    for (; x < iEnd; x++)
     {
-        fprintf(stderr, "Could not initialize PNG info data.\n");
-        png_destroy_read_struct(pngPtr, (png_infopp)NULL, (png_infopp)NULL);
-        fclose(pFile);
-        exit(1);
+        if (pRow[x * RGBA_CHANNELS_PER_PIXEL + CH_OPACITY] != TRANSPARENT)
+            return x;
     }
+    return iEnd;
+}
 
-    *endInfo = png_create_info_struct(*pngPtr);
-    if(!*endInfo)
+//! Find the last pixel in a row that is not fully transparent.
+/*!
+    With SSE2, pixels are tested four at a time.
+    @param pRow Row of pixel channels, as loaded from the .PNG file.
+    @param iFirst First column to test.
+    @param iEnd Column after the last column to test.
+    @return Column of the last pixel that is not fully transparent, or \a iFirst - 1 if there is none.
+ */
+static int FindLastVisible(const uint8 *pRow, int iFirst, int iEnd)
+{
+    int x = iEnd;
+#ifdef __SSE2__
+    for (; x - 4 >= iFirst; x -= 4)
     {
-        fprintf(stderr, "Could not initialize PNG end data.\n");
-        png_destroy_read_struct(pngPtr, infoPtr, (png_infopp)NULL);
-        fclose(pFile);
-        exit(1);
+        int iVisible = GetVisibleMask(pRow + (x - 4) * RGBA_CHANNELS_PER_PIXEL);
+        if (iVisible != 0)
+        {
+            x--;
+            while ((iVisible & 8) == 0)
+            {
+                iVisible <<= 1;
+                x--;
+            }
+            return x;
+        }
     }
+#endif
+    x--;
+    while (x >= iFirst && pRow[x * RGBA_CHANNELS_PER_PIXEL + CH_OPACITY] == TRANSPARENT)
+        x--;
+    return x;
+}
 
-    /* Setup callback in case of errors. */
-    if(setjmp(png_jmpbuf(*pngPtr))) {
-        fprintf(stderr, "Error detected while reading PNG file.\n");
-        png_destroy_read_struct(pngPtr, infoPtr, endInfo);
-        fclose(pFile);
-        exit(1);
-    }
+//! Rectangle of an image file, the key of the cropping cache.
+struct CropArea
+{
+    std::string sFilename; ///< Filename of the image.
+    int iLeft;   ///< Left-most column of the rectangle.
+    int iTop;    ///< Top-most row of the rectangle.
+    int iWidth;  ///< Number of columns of the rectangle.
+    int iHeight; ///< Number of rows of the rectangle.
 
-    /* Initialize for file reading. */
-    png_init_io(*pngPtr, pFile);
-    png_set_sig_bytes(*pngPtr, PNG_SIGNATURE_SIZE);
+    bool operator<(const CropArea &ca) const
+    {
+        if (sFilename != ca.sFilename) return sFilename < ca.sFilename;
+        if (iLeft != ca.iLeft) return iLeft < ca.iLeft;
+        if (iTop != ca.iTop) return iTop < ca.iTop;
+        if (iWidth != ca.iWidth) return iWidth < ca.iWidth;
+        return iHeight < ca.iHeight;
+    }
+};
 
-    png_read_png(*pngPtr, *infoPtr, PNG_TRANSFORM_IDENTITY, NULL);
-    *pRows = png_get_rows(*pngPtr, *infoPtr);
-    fclose(pFile);
-}
+static std::map<CropArea, CropArea> g_mapCroppings; ///< Cropped rectangle of each cropped rectangle of an image.
 
 //! Perform cropping on the image.
 /*!
-    @param pRows Data of the sprite, as loaded from the .PNG file.
+    The image is scanned row by row, the result is kept for cropping the same rectangle again.
+    @param sFilename Filename of the image.
+    @param oPixels Pixels of the area to crop, as loaded from the image file.
     @param[inout] left_edge Coordinate of the left-most column of the sprite. Updated in-place.
     @param[inout] top_edge Coordinate of the top-most row of the sprite. Updated in-place.
     @param[inout] width Number of columns in the image. Updated in-place.
@@ -215,105 +408,72 @@ static void OpenFile(const std::string &sFilename, png_structp *pngPtr, png_info
     @param[inout] xoffset Horizontal offset for displaying the sprite relative to the farthest corner of the tile. Updated in-place.
     @param[inout] yoffset Vertical offset for displaying the sprite relative to the farthest corner of the tile. Updated in-place.
  */
-static void PerformCropping(uint8 **pRows, int *left_edge, int *top_edge, int *width, int *height, int *xoffset, int *yoffset)
+static void PerformCropping(const std::string &sFilename, const ImageArea &oPixels, int *left_edge, int *top_edge, int *width, int *height, int *xoffset, int *yoffset)
 {
-    int xpoint = *left_edge - *xoffset;
-    int ypoint = *top_edge - *yoffset;
-    int left = *left_edge;
-    int top = *top_edge;
-    int right = left + *width - 1;
-    int bottom = top + *height - 1;
-
-    while (left <= right)
+    CropArea oArea;
+    oArea.sFilename = sFilename;
+    oArea.iLeft = *left_edge;
+    oArea.iTop = *top_edge;
+    oArea.iWidth = *width;
+    oArea.iHeight = *height;
+
+    std::map<CropArea, CropArea>::iterator iter = g_mapCroppings.find(oArea);
+    if (iter == g_mapCroppings.end())
     {
-        bool ok = true;
-        for (int y = top; y <= bottom; y++)
+        // Columns and rows are relative to the top-left corner of the area.
+        int iEnd = oArea.iWidth;
+        int left = iEnd;   // Left-most visible column.
+        int right = -1;    // Right-most visible column.
+        int top = -1;      // Top-most visible row.
+        int bottom = -1;   // Bottom-most visible row.
+        for (int y = 0; y < oArea.iHeight; y++)
         {
-            uint8 *pPixel = pRows[y] + left;
-            if (pPixel[CH_OPACITY] != TRANSPARENT)
-            {
-                ok = false;
-                break;
-            }
-        }
-        if (!ok)
-            break;
-
-        left++;
-    }
-    while (left <= right)
-    {
-        bool ok = true;
-        for (int y = top; y <= bottom; y++)
-        {
-            uint8 *pPixel = pRows[y] + right;
-            if (pPixel[CH_OPACITY] != TRANSPARENT)
-            {
-                ok = false;
-                break;
-            }
+            const uint8 *pRow = oPixels.m_vRows[y];
+            int iFirst = FindFirstVisible(pRow, 0, iEnd);
+            if (iFirst == iEnd)
+                continue; // Fully transparent row.
+
+            if (top < 0) top = y;
+            bottom = y;
+            if (iFirst < left) left = iFirst;
+            // Only columns right of the current right-most visible column can extend it.
+            int iLast = FindLastVisible(pRow, (right + 1 > iFirst) ? right + 1 : iFirst, iEnd);
+            if (iLast > right) right = iLast;
         }
-        if (!ok)
-            break;
-
-        right--;
-    }
 
-    while (top <= bottom)
-    {
-        bool ok = true;
-        for (int x = left; x <= right; x++)
+        CropArea oCropped = oArea;
+        if (top < 0)
         {
-            uint8 *pPixel = pRows[top] + x;
-            if (pPixel[CH_OPACITY] != TRANSPARENT)
-            {
-                ok = false;
-                break;
-            }
+            oCropped.iWidth = 0;
+            oCropped.iHeight = 0;
         }
-        if (!ok)
-            break;
-
-        top++;
-    }
-    while (top <= bottom)
-    {
-        bool ok = true;
-        for (int x = left; x <= right; x++)
+        else
         {
-            uint8 *pPixel = pRows[bottom] + x;
-            if (pPixel[CH_OPACITY] != TRANSPARENT)
-            {
-                ok = false;
-                break;
-            }
+            oCropped.iLeft = oArea.iLeft + left;
+            oCropped.iTop = oArea.iTop + top;
+            oCropped.iWidth = right - left + 1;
+            oCropped.iHeight = bottom - top + 1;
         }
-        if (!ok)
-            break;
-
-        bottom--;
+        iter = g_mapCroppings.insert(std::make_pair(oArea, oCropped)).first;
     }
 
-    *left_edge = left;
-    *top_edge = top;
-    *width = right - left + 1;
-    *height = bottom - top + 1;
-    *xoffset = left - xpoint;
-    *yoffset = top - ypoint;
+    const CropArea &oCropped = iter->second;
+    *xoffset += oCropped.iLeft - *left_edge;
+    *yoffset += oCropped.iTop - *top_edge;
+    *left_edge = oCropped.iLeft;
+    *top_edge = oCropped.iTop;
+    *width = oCropped.iWidth;
+    *height = oCropped.iHeight;
 }
 
 Image32bpp *Load32Bpp(const std::string &sFilename, int line, int *left, int *width, int *top, int *height, int *xoffset, int *yoffset)
 {
-    png_structp pngPtr;
-    png_infop infoPtr;
-    png_infop endInfo;
-    uint8 **pRows;
-    OpenFile(sFilename, &pngPtr, &infoPtr, &endInfo, &pRows);
+    TraceSpan oSpan("Load32Bpp", sFilename);
+    const LoadedImage &oFile = g_oImageCache.Get(sFilename, IP_RGBA);
 
-    int iWidth = png_get_image_width(pngPtr, infoPtr);
-    int iHeight = png_get_image_height(pngPtr, infoPtr);
-    int iBitDepth = png_get_bit_depth(pngPtr, infoPtr);
-    int iColorType = png_get_color_type(pngPtr, infoPtr);
+    int iWidth = oFile.m_iWidth;
+    int iHeight = oFile.m_iHeight;
+    int iBitDepth = oFile.m_iBitDepth;
 
     /* Initialize sprite width and height if not set, clamping at 0. */
     if (*width < 0)
@@ -341,21 +501,23 @@ Image32bpp *Load32Bpp(const std::string &sFilename, int line, int *left, int *wi
     if (iBitDepth != 8)
     {
         fprintf(stderr, "Sprite at line %d: \"%s\" is not an 32bpp file (channels are not 8 bit wide)\n", line, sFilename.c_str());
-        png_destroy_read_struct(&pngPtr, &infoPtr, &endInfo);
         exit(1);
     }
-    if (iColorType != PNG_COLOR_TYPE_RGB_ALPHA)
+    if (oFile.m_ePixels != IP_RGBA)
     {
         fprintf(stderr, "Sprite at line %d: \"%s\" is not an RGBA file\n", line, sFilename.c_str());
-        png_destroy_read_struct(&pngPtr, &infoPtr, &endInfo);
         exit(1);
     }
 
-    PerformCropping(pRows, left, top, width, height, xoffset, yoffset);
+    ImageArea oPixels;
+    oFile.GetArea(*left, *top, *width, *height, &oPixels);
+    int iAreaLeft = *left;
+    int iAreaTop = *top;
+
+    PerformCropping(sFilename, oPixels, left, top, width, height, xoffset, yoffset);
     if (*width == 0 || *height == 0)
     {
         fprintf(stderr, "Sprite at line %d: \"%s\" is empty\n", line, sFilename.c_str());
-        png_destroy_read_struct(&pngPtr, &infoPtr, &endInfo);
         exit(1);
     }
 
@@ -363,7 +525,7 @@ Image32bpp *Load32Bpp(const std::string &sFilename, int line, int *left, int *wi
     uint32 *pData = img->pData;
     for (int i = 0; i < *height; i++)
     {
-        uint8 *pRow = pRows[*top + i] + (*left * RGBA_CHANNELS_PER_PIXEL);
+        const uint8 *pRow = oPixels.m_vRows[*top - iAreaTop + i] + ((*left - iAreaLeft) * RGBA_CHANNELS_PER_PIXEL);
         for (int j = 0; j < *width; j++)
         {
             *pData++ = MakeRGBA(pRow[CH_RED], pRow[CH_GREEN], pRow[CH_BLUE], pRow[CH_OPACITY]);
@@ -371,22 +533,17 @@ Image32bpp *Load32Bpp(const std::string &sFilename, int line, int *left, int *wi
         }
     }
 
-    png_destroy_read_struct(&pngPtr, &infoPtr, &endInfo);
+    oSpan.SetBytes((long long)*width * *height * RGBA_CHANNELS_PER_PIXEL);
     return img;
 }
 
 Image8bpp *Load8Bpp(const std::string &sFilename, int line, int left, int width, int top, int height)
 {
-    png_structp pngPtr;
-    png_infop infoPtr;
-    png_infop endInfo;
-    uint8 **pRows;
-    OpenFile(sFilename, &pngPtr, &infoPtr, &endInfo, &pRows);
+    const LoadedImage &oFile = g_oImageCache.Get(sFilename, IP_INDEXED);
 
-    int iWidth = png_get_image_width(pngPtr, infoPtr);
-    int iHeight = png_get_image_height(pngPtr, infoPtr);
-    int iBitDepth = png_get_bit_depth(pngPtr, infoPtr);
-    int iColorType = png_get_color_type(pngPtr, infoPtr);
+    int iWidth = oFile.m_iWidth;
+    int iHeight = oFile.m_iHeight;
+    int iBitDepth = oFile.m_iBitDepth;
 
     if (iWidth < left + width)
     {
@@ -402,25 +559,25 @@ Image8bpp *Load8Bpp(const std::string &sFilename, int line, int left, int width,
     if (iBitDepth != 8)
     {
         fprintf(stderr, "Sprite at line %d: \"%s\" is not an 8bpp file (the channel is not 8 bit wide)\n", line, sFilename.c_str());
-        png_destroy_read_struct(&pngPtr, &infoPtr, &endInfo);
         exit(1);
     }
-    if (iColorType != PNG_COLOR_TYPE_PALETTE)
+    if (oFile.m_ePixels != IP_INDEXED)
     {
         fprintf(stderr, "Sprite at line %d: \"%s\" is not a palleted image file\n", line, sFilename.c_str());
-        png_destroy_read_struct(&pngPtr, &infoPtr, &endInfo);
         exit(1);
     }
 
+    ImageArea oPixels;
+    oFile.GetArea(left, top, width, height, &oPixels);
+
     Image8bpp *img = new Image8bpp(width, height);
     uint8 *pData = img->pData;
     for (int i = 0; i < height; i++)
     {
-        int y = top + i;
+        const uint8 *pRow = oPixels.m_vRows[i];
         for (int j = 0; j < width; j++)
         {
-            int x = left + j;
-            uint8 v = pRows[y][x];
+            uint8 v = pRow[j];
             *pData = v;
             pData++;
         }
@@ -428,4 +585,64 @@ Image8bpp *Load8Bpp(const std::string &sFilename, int line, int left, int width,
     return img;
 }
 
+void Save32Bpp(const std::string &sFilename, const Image32bpp &img, bool bRaw)
+{
+    FILE *pFile = fopen(sFilename.c_str(), "wb");
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open \"%s\" for writing.\n", sFilename.c_str());
+        exit(1);
+    }
+
+    // Convert the pixels to rows of RGBA channels.
+    uint8 *pChannels = (uint8 *)malloc(RGBA_CHANNELS_PER_PIXEL * img.iWidth * img.iHeight);
+    png_bytep *pRows = (png_bytep *)malloc(sizeof(png_bytep) * img.iHeight);
+    for (int i = 0; i < img.iWidth * img.iHeight; i++)
+    {
+        uint8 *pPixel = pChannels + RGBA_CHANNELS_PER_PIXEL * i;
+        pPixel[CH_RED] = GetR(img.pData[i]);
+        pPixel[CH_GREEN] = GetG(img.pData[i]);
+        pPixel[CH_BLUE] = GetB(img.pData[i]);
+        pPixel[CH_OPACITY] = GetA(img.pData[i]);
+    }
+    for (int y = 0; y < img.iHeight; y++)
+        pRows[y] = pChannels + RGBA_CHANNELS_PER_PIXEL * img.iWidth * y;
+
+    if (bRaw)
+    {
+        size_t iSize = RGBA_CHANNELS_PER_PIXEL * img.iWidth * img.iHeight;
+        if (fwrite(pChannels, 1, iSize, pFile) != iSize)
+        {
+            fprintf(stderr, "Writing \"%s\" failed.\n", sFilename.c_str());
+            exit(1);
+        }
+    }
+    else
+    {
+        png_structp pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+        png_infop infoPtr = (pngPtr != NULL) ? png_create_info_struct(pngPtr) : NULL;
+        if (infoPtr == NULL)
+        {
+            fprintf(stderr, "Could not initialize PNG data.\n");
+            exit(1);
+        }
+        if (setjmp(png_jmpbuf(pngPtr)))
+        {
+            fprintf(stderr, "Error detected while writing PNG file \"%s\".\n", sFilename.c_str());
+            exit(1);
+        }
+
+        png_init_io(pngPtr, pFile);
+        png_set_IHDR(pngPtr, infoPtr, img.iWidth, img.iHeight, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+                     PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_set_rows(pngPtr, infoPtr, pRows);
+        png_write_png(pngPtr, infoPtr, PNG_TRANSFORM_IDENTITY, NULL);
+        png_destroy_write_struct(&pngPtr, &infoPtr);
+    }
+
+    free(pRows);
+    free(pChannels);
+    fclose(pFile);
+}
+
 // vim: et sw=4 ts=4 sts=4
@@ -25,6 +25,8 @@ SOFTWARE.
 #ifndef IMAGE_H
 #define IMAGE_H
 
+#include <cstddef>
+
 typedef unsigned char uint8;
 typedef unsigned int uint32;
 
@@ -55,10 +57,23 @@ public:
      */
     uint32 Get(int offset) const;
 
+    //! Get the opacity of the pixel at the given \a offset.
+    /*!
+        @param offset Offset of the pixel to retrieve, in pixels from the top-left, in horizontal rows.
+     */
+    uint8 GetOpacity(int offset) const
+    {
+        return (pOpacity != NULL) ? pOpacity[offset] : (uint8)(Get(offset) >> 24);
+    }
+
+    void MakeOpacityPlane();
+
     int iWidth;    ///< Width of the image in pixels.
     int iHeight;   ///< Height of the image in pixels.
     uint32 *pData; ///< Stored data, one value per pixel, in horizontal rows.
                    ///< Encoded using #MakeRGBA, decoding to channels with #GetR, #GetG, #GetB, #GetA.
+    uint8 *pOpacity; ///< Opacity of each pixel as separate plane made by #MakeOpacityPlane, else \c NULL.
+                     ///< Must be made again after changing \a pData.
 };
 
 /** 8bpp image storage, for recolouring layers. */
@@ -90,6 +105,16 @@ public:
     uint8 *pData; ///< Stored data, one value per pixel, in horizontal rows.
 };
 
+//! Encode the colour channels of a pixel into a single value.
+/*!
+    @param r Amount of red colour.
+    @param g Amount of green colour.
+    @param b Amount of blue colour.
+    @param a Amount of opacity.
+    @return The encoded pixel value.
+ */
+uint32 MakeRGBA(uint8 r, uint8 g, uint8 b, uint8 a);
+
 //! Get the red colour channel from the encoded \a rgba pixel.
 /*!
     @param rgba Encoded pixel value.
@@ -146,6 +171,14 @@ Image32bpp *Load32Bpp(const std::string &sFilename, int line, int *left, int *wi
  */
 Image8bpp *Load8Bpp(const std::string &sFilename, int line, int left, int width, int top, int height);
 
+//! Save a 32bpp image to a file.
+/*!
+    @param sFilename Name of the file to write.
+    @param img Image to save.
+    @param bRaw Write the raw RGBA pixels (4 bytes each, in horizontal rows) instead of a PNG file.
+ */
+void Save32Bpp(const std::string &sFilename, const Image32bpp &img, bool bRaw);
+
 #endif
 
 // vim: et sw=4 ts=4 sts=4
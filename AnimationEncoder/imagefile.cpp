@@ -0,0 +1,743 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file imagefile.cpp Loading of image files in the supported file formats.
+/*!
+    Supported are PNG files (with libpng), QOI files, and raw image files. A raw image
+    file has a header of 16 bytes, followed by the rows of pixels without compression.
+
+    Offset  Length  Description
+       0       4    Identification 'C', 'T', 'R', 'I'.
+       4       4    Width of the image (little endian).
+       8       4    Height of the image (little endian).
+      12       1    Number of channels, 4 for RGBA pixels, 1 for palette indices.
+      13       3    Unused, 0.
+      16       ?    Pixels, in horizontal rows.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <png.h>
+#include "imagefile.h"
+#include "filedata.h"
+#include "storage.h"
+#include "trace.h"
+
+static const int RAW_HEADER_SIZE = 16; ///< Number of bytes of the header of a raw image file.
+static const int QOI_HEADER_SIZE = 14; ///< Number of bytes of the header of a QOI file.
+
+LoadedImage::LoadedImage()
+{
+    m_iWidth = 0;
+    m_iHeight = 0;
+    m_iBitDepth = 8;
+    m_ePixels = IP_OTHER;
+    m_eWanted = IP_OTHER;
+    m_pRows = NULL;
+}
+
+LoadedImage::~LoadedImage()
+{
+}
+
+//! Get the pixels of a rectangular area of the image.
+/*!
+    @param iLeft Left-most column of the area.
+    @param iTop Top-most row of the area.
+    @param iWidth Number of columns of the area.
+    @param iHeight Number of rows of the area.
+    @param [out] pArea Pixels of the area, valid while the image exists.
+    @pre The area is inside the image.
+ */
+void LoadedImage::GetArea(int iLeft, int iTop, int iWidth, int iHeight, ImageArea *pArea) const
+{
+    (void)iWidth; // The rows are used from the left-most column onwards.
+    pArea->m_vRows.resize(iHeight);
+    for (int y = 0; y < iHeight; y++)
+        pArea->m_vRows[y] = m_pRows[iTop + y] + iLeft * GetPixelSize();
+}
+
+ImageLoader::~ImageLoader()
+{
+}
+
+//! Get a 32 bit little endian number.
+/*!
+    @param pData First byte of the number.
+    @return The number.
+ */
+static uint32 GetLittleEndian32(const unsigned char *pData)
+{
+    return pData[0] | (pData[1] << 8) | (pData[2] << 16) | ((uint32)pData[3] << 24);
+}
+
+//! Store a 32 bit little endian number.
+/*!
+    @param [out] pData First byte of the number.
+    @param iValue Value to store.
+ */
+static void PutLittleEndian32(unsigned char *pData, uint32 iValue)
+{
+    pData[0] = iValue & 0xFF;
+    pData[1] = (iValue >> 8) & 0xFF;
+    pData[2] = (iValue >> 16) & 0xFF;
+    pData[3] = (iValue >> 24) & 0xFF;
+}
+
+//! Get a 32 bit big endian number.
+/*!
+    @param pData First byte of the number.
+    @return The number.
+ */
+static uint32 GetBigEndian32(const unsigned char *pData)
+{
+    return ((uint32)pData[0] << 24) | (pData[1] << 16) | (pData[2] << 8) | pData[3];
+}
+
+//! Position in the contents of a file being read by libpng.
+struct PngReader
+{
+    const FileData *pFile; ///< File being read.
+    size_t iPos;           ///< Offset of the next byte to read.
+};
+
+//! Libpng read function, copying the next bytes from the contents of the file.
+/*!
+    @param pngPtr Libpng data structure.
+    @param pData [out] Destination of the read bytes.
+    @param iLength Number of bytes to read.
+ */
+static void ReadPngData(png_structp pngPtr, png_bytep pData, png_size_t iLength)
+{
+    PngReader *pReader = static_cast<PngReader *>(png_get_io_ptr(pngPtr));
+    if (iLength > pReader->pFile->m_iSize - pReader->iPos)
+        png_error(pngPtr, "Unexpected end of file");
+
+    memcpy(pData, pReader->pFile->m_pData + pReader->iPos, iLength);
+    pReader->iPos += iLength;
+}
+
+//! A loaded image with its pixels in memory owned by the image.
+class BufferImage : public LoadedImage
+{
+public:
+    //! Constructor.
+    /*!
+        @param sFilename Filename of the image.
+        @param iWidth Width of the image in pixels.
+        @param iHeight Height of the image in pixels.
+        @param iRowBytes Number of bytes of a row of pixels.
+        @param ePixels Kind of pixels.
+     */
+    BufferImage(const std::string &sFilename, int iWidth, int iHeight, size_t iRowBytes, ImagePixels ePixels)
+    {
+        m_sFilename = sFilename;
+        m_iWidth = iWidth;
+        m_iHeight = iHeight;
+        m_ePixels = ePixels;
+        m_vPixels.resize(iRowBytes * iHeight);
+        m_vRows.resize(iHeight);
+        for (int y = 0; y < iHeight; y++)
+            m_vRows[y] = &m_vPixels[0] + y * iRowBytes;
+        m_pRows = (iHeight > 0) ? &m_vRows[0] : NULL;
+    }
+
+    std::vector<uint8> m_vPixels; ///< Pixel channel information.
+    std::vector<uint8 *> m_vRows; ///< Start of each row in \a m_vPixels.
+};
+
+//! Select the libpng transformations for getting the wanted kind of pixels from a PNG file.
+/*!
+    A file that already has the wanted pixels (8 bit RGBA, or 8 bit palette indices) is not transformed.
+    For RGBA pixels, palette and grayscale images are expanded, 16 bit channels are reduced to 8 bit,
+    and a missing opacity channel is added (from the \c tRNS chunk if available, else fully opaque).
+    For palette indices, only indices of less than 8 bit are unpacked.
+    @param pngPtr Libpng data structure, after reading the file information.
+    @param infoPtr Libpng info structure.
+    @param eWanted Wanted kind of pixels.
+ */
+static void SetPngTransforms(png_structp pngPtr, png_infop infoPtr, ImagePixels eWanted)
+{
+    int iBitDepth = png_get_bit_depth(pngPtr, infoPtr);
+    int iColorType = png_get_color_type(pngPtr, infoPtr);
+
+    if (eWanted == IP_INDEXED)
+    {
+        if (iColorType == PNG_COLOR_TYPE_PALETTE && iBitDepth < 8)
+            png_set_packing(pngPtr);
+        return;
+    }
+
+    if (iColorType == PNG_COLOR_TYPE_RGB_ALPHA && iBitDepth == 8)
+        return; // Native RGBA, nothing to do.
+
+    if (iColorType == PNG_COLOR_TYPE_PALETTE)
+        png_set_palette_to_rgb(pngPtr);
+    if (iColorType == PNG_COLOR_TYPE_GRAY && iBitDepth < 8)
+        png_set_expand_gray_1_2_4_to_8(pngPtr);
+    if (png_get_valid(pngPtr, infoPtr, PNG_INFO_tRNS))
+        png_set_tRNS_to_alpha(pngPtr);
+    if (iBitDepth == 16)
+        png_set_strip_16(pngPtr);
+    if (iColorType == PNG_COLOR_TYPE_GRAY || iColorType == PNG_COLOR_TYPE_GRAY_ALPHA)
+        png_set_gray_to_rgb(pngPtr);
+    if ((iColorType & PNG_COLOR_MASK_ALPHA) == 0 && !png_get_valid(pngPtr, infoPtr, PNG_INFO_tRNS))
+        png_set_add_alpha(pngPtr, OPAQUE, PNG_FILLER_AFTER);
+}
+
+//! Load a PNG file.
+/*!
+    The pixels are transformed while decoding, see #SetPngTransforms.
+    @param oFile Contents of the file.
+    @param eWanted Wanted kind of pixels.
+    @return The loaded image.
+ */
+static LoadedImage *LoadPng(const FileData &oFile, ImagePixels eWanted)
+{
+    const int PNG_SIGNATURE_SIZE = 4; // Number of bytes checked by the loader.
+
+    png_structp pngPtr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (!pngPtr)
+    {
+        fprintf(stderr, "Could not initialize PNG data.\n");
+        exit(1);
+    }
+    png_infop infoPtr = png_create_info_struct(pngPtr);
+    if(!infoPtr)
+    {
+        fprintf(stderr, "Could not initialize PNG info data.\n");
+        png_destroy_read_struct(&pngPtr, (png_infopp)NULL, (png_infopp)NULL);
+        exit(1);
+    }
+
+    png_infop endInfo = png_create_info_struct(pngPtr);
+    if(!endInfo)
+    {
+        fprintf(stderr, "Could not initialize PNG end data.\n");
+        png_destroy_read_struct(&pngPtr, &infoPtr, (png_infopp)NULL);
+        exit(1);
+    }
+
+    /* Setup callback in case of errors. */
+    if(setjmp(png_jmpbuf(pngPtr))) {
+        fprintf(stderr, "Error detected while reading PNG file.\n");
+        png_destroy_read_struct(&pngPtr, &infoPtr, &endInfo);
+        exit(1);
+    }
+
+    /* Initialize for reading from the file contents. */
+    PngReader oReader;
+    oReader.pFile = &oFile;
+    oReader.iPos = PNG_SIGNATURE_SIZE;
+    png_set_read_fn(pngPtr, &oReader, ReadPngData);
+    png_set_sig_bytes(pngPtr, PNG_SIGNATURE_SIZE);
+
+    png_read_info(pngPtr, infoPtr);
+    SetPngTransforms(pngPtr, infoPtr, eWanted);
+    png_set_interlace_handling(pngPtr);
+    png_read_update_info(pngPtr, infoPtr);
+
+    ImagePixels ePixels = IP_OTHER;
+    int iBitDepth = png_get_bit_depth(pngPtr, infoPtr);
+    switch (png_get_color_type(pngPtr, infoPtr))
+    {
+        case PNG_COLOR_TYPE_RGB_ALPHA: ePixels = IP_RGBA;    break;
+        case PNG_COLOR_TYPE_PALETTE:   ePixels = IP_INDEXED; break;
+        default:                       ePixels = IP_OTHER;   break;
+    }
+
+    BufferImage *pImage = new BufferImage(oFile.m_sFilename, png_get_image_width(pngPtr, infoPtr),
+                                          png_get_image_height(pngPtr, infoPtr),
+                                          png_get_rowbytes(pngPtr, infoPtr), ePixels);
+    pImage->m_iBitDepth = iBitDepth;
+    png_read_image(pngPtr, pImage->m_pRows);
+    png_read_end(pngPtr, endInfo);
+    png_destroy_read_struct(&pngPtr, &infoPtr, &endInfo);
+    return pImage;
+}
+
+//! Loader of PNG files.
+class PngLoader : public ImageLoader
+{
+public:
+    const char *GetName() const
+    {
+        return "PNG";
+    }
+
+    bool Matches(const FileData &oFile) const
+    {
+        return oFile.m_iSize >= 4 && png_sig_cmp(const_cast<png_bytep>(oFile.m_pData), 0, 4) == 0;
+    }
+
+    LoadedImage *Load(const FileData &oFile, ImagePixels eWanted) const
+    {
+        return LoadPng(oFile, eWanted);
+    }
+};
+
+//! Loader of QOI ("Quite OK Image") files.
+class QoiLoader : public ImageLoader
+{
+public:
+    const char *GetName() const
+    {
+        return "QOI";
+    }
+
+    bool Matches(const FileData &oFile) const
+    {
+        return oFile.m_iSize >= (size_t)QOI_HEADER_SIZE && memcmp(oFile.m_pData, "qoif", 4) == 0;
+    }
+
+    LoadedImage *Load(const FileData &oFile, ImagePixels eWanted) const;
+};
+
+//! Report that a QOI file ends before all its pixels are decoded, and exit.
+/*!
+    @param oFile Contents of the file.
+ */
+static void QoiTruncated(const FileData &oFile)
+{
+    fprintf(stderr, "QOI file \"%s\" ends unexpectedly.\n", oFile.m_sFilename.c_str());
+    exit(1);
+}
+
+LoadedImage *QoiLoader::Load(const FileData &oFile, ImagePixels) const
+{
+    const unsigned char *pData = oFile.m_pData;
+    uint32 iWidth = GetBigEndian32(pData + 4);
+    uint32 iHeight = GetBigEndian32(pData + 8);
+    if (iWidth == 0 || iHeight == 0 || iWidth > 65535 || iHeight > 65535 || (pData[12] != 3 && pData[12] != 4))
+    {
+        fprintf(stderr, "QOI file \"%s\" has an unsupported header.\n", oFile.m_sFilename.c_str());
+        exit(1);
+    }
+
+    BufferImage *pImage = new BufferImage(oFile.m_sFilename, iWidth, iHeight, (size_t)iWidth * 4, IP_RGBA);
+    uint8 aIndex[64][4];
+    memset(aIndex, 0, sizeof(aIndex));
+    uint8 aPixel[4] = {0, 0, 0, 255};
+
+    size_t iPos = QOI_HEADER_SIZE;
+    uint8 *pDest = &pImage->m_vPixels[0];
+    uint8 *pEnd = pDest + pImage->m_vPixels.size();
+    while (pDest < pEnd)
+    {
+        if (iPos >= oFile.m_iSize)
+            QoiTruncated(oFile);
+
+        int iRun = 1;
+        uint8 iOp = pData[iPos++];
+        if (iOp == 0xFE || iOp == 0xFF) // RGB or RGBA.
+        {
+            int iCount = (iOp == 0xFE) ? 3 : 4;
+            if (iPos + iCount > oFile.m_iSize)
+                QoiTruncated(oFile);
+            memcpy(aPixel, pData + iPos, iCount);
+            iPos += iCount;
+        }
+        else if ((iOp & 0xC0) == 0x00) // Index.
+        {
+            memcpy(aPixel, aIndex[iOp & 0x3F], 4);
+        }
+        else if ((iOp & 0xC0) == 0x40) // Small difference.
+        {
+            aPixel[0] += ((iOp >> 4) & 0x03) - 2;
+            aPixel[1] += ((iOp >> 2) & 0x03) - 2;
+            aPixel[2] += (iOp & 0x03) - 2;
+        }
+        else if ((iOp & 0xC0) == 0x80) // Difference relative to green.
+        {
+            if (iPos >= oFile.m_iSize)
+                QoiTruncated(oFile);
+            uint8 iOp2 = pData[iPos++];
+            int iGreen = (iOp & 0x3F) - 32;
+            aPixel[0] += iGreen - 8 + ((iOp2 >> 4) & 0x0F);
+            aPixel[1] += iGreen;
+            aPixel[2] += iGreen - 8 + (iOp2 & 0x0F);
+        }
+        else // Run of the previous pixel.
+        {
+            iRun = (iOp & 0x3F) + 1;
+        }
+
+        memcpy(aIndex[(aPixel[0] * 3 + aPixel[1] * 5 + aPixel[2] * 7 + aPixel[3] * 11) % 64], aPixel, 4);
+        while (iRun > 0 && pDest < pEnd)
+        {
+            memcpy(pDest, aPixel, 4);
+            pDest += 4;
+            iRun--;
+        }
+    }
+    return pImage;
+}
+
+//! A loaded raw image file, the pixels are used directly from the mapped file.
+class RawImage : public LoadedImage
+{
+public:
+    //! Load a raw image file.
+    /*!
+        @param oFile Contents of the file, for checking the header.
+     */
+    RawImage(const FileData &oFile) : m_oFile(oFile.m_sFilename)
+    {
+        m_sFilename = oFile.m_sFilename;
+        const unsigned char *pData = m_oFile.m_pData;
+        int iChannels = (m_oFile.m_iSize >= (size_t)RAW_HEADER_SIZE) ? pData[12] : 0;
+        if (iChannels != 1 && iChannels != 4)
+        {
+            fprintf(stderr, "Raw image file \"%s\" has an unsupported header.\n", m_sFilename.c_str());
+            exit(1);
+        }
+
+        m_iWidth = GetLittleEndian32(pData + 4);
+        m_iHeight = GetLittleEndian32(pData + 8);
+        m_ePixels = (iChannels == 4) ? IP_RGBA : IP_INDEXED;
+        if (m_iWidth < 0 || m_iHeight < 0 || m_iWidth > 65535 || m_iHeight > 65535
+                || m_oFile.m_iSize < RAW_HEADER_SIZE + (size_t)m_iWidth * m_iHeight * iChannels)
+        {
+            fprintf(stderr, "Raw image file \"%s\" is too short for its size.\n", m_sFilename.c_str());
+            exit(1);
+        }
+
+        m_vRows.resize(m_iHeight);
+        for (int y = 0; y < m_iHeight; y++)
+            m_vRows[y] = const_cast<uint8 *>(pData) + RAW_HEADER_SIZE + (size_t)y * m_iWidth * iChannels;
+        m_pRows = (m_iHeight > 0) ? &m_vRows[0] : NULL;
+    }
+
+    FileData m_oFile;             ///< Contents of the file, the rows point into it (read-only).
+    std::vector<uint8 *> m_vRows; ///< Start of each row in the file.
+};
+
+//! Loader of raw image files.
+class RawLoader : public ImageLoader
+{
+public:
+    const char *GetName() const
+    {
+        return "raw";
+    }
+
+    bool Matches(const FileData &oFile) const
+    {
+        return oFile.m_iSize >= (size_t)RAW_HEADER_SIZE && memcmp(oFile.m_pData, "CTRI", 4) == 0;
+    }
+
+    LoadedImage *Load(const FileData &oFile, ImagePixels) const
+    {
+        return new RawImage(oFile);
+    }
+};
+
+static const PngLoader g_oPngLoader; ///< Loader of PNG files.
+static const QoiLoader g_oQoiLoader; ///< Loader of QOI files.
+static const RawLoader g_oRawLoader; ///< Loader of raw image files.
+
+//! Available loaders, the first loader matching a file loads it.
+static const ImageLoader *g_aLoaders[] = {&g_oPngLoader, &g_oQoiLoader, &g_oRawLoader};
+
+static const int TILE_SIZE_BITS = 6;              ///< Tiles of a tiled sheet file are 2**6 = 64 pixels wide and high.
+static const int TILE_SIZE = 1 << TILE_SIZE_BITS; ///< Width and height of a tile of a tiled sheet file.
+static const int TILES_HEADER_SIZE = 32;          ///< Number of used bytes of the header of a tiled sheet file.
+static const int TILES_DATA_OFFSET = 4096;        ///< Offset of the first tile in a tiled sheet file (page aligned).
+
+/*
+    A tiled sheet file is a decoded PNG file in the sheet cache, its pixels are
+    stored in tiles of 64x64 pixels, so an area of the image can be copied from
+    the (memory mapped) file by reading only the tiles that overlap with it.
+
+    Offset  Length  Description
+       0       4    Identification 'C', 'T', 'T', 'L'.
+       4       4    Width of the image (little endian).
+       8       4    Height of the image (little endian).
+      12       1    Number of bytes of a pixel, 4 for RGBA pixels, 1 for palette indices.
+      13       1    Width and height of a tile, as power of 2 (#TILE_SIZE_BITS).
+      14       2    Unused, 0.
+      16       8    Size of the PNG file (little endian).
+      24       8    Hash of the contents of the PNG file (little endian).
+    4096       ?    Tiles in horizontal rows, each tile has its pixels in horizontal
+                    rows. Pixels of the tiles at the right and bottom edge outside
+                    the image are 0.
+*/
+
+//! Compute the hash of the contents of a file (64 bit FNV-1a).
+/*!
+    @param oFile Contents of the file.
+    @return Hash of the contents.
+ */
+static unsigned long long HashFileData(const FileData &oFile)
+{
+    unsigned long long iHash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < oFile.m_iSize; i++)
+    {
+        iHash ^= oFile.m_pData[i];
+        iHash *= 0x100000001B3ULL;
+    }
+    return iHash;
+}
+
+//! Compute the number of bytes of the tiles of a tiled sheet file.
+/*!
+    @param iWidth Width of the image.
+    @param iHeight Height of the image.
+    @param iPixelSize Number of bytes of a pixel.
+    @return Number of bytes of all tiles.
+ */
+static size_t GetTilesSize(int iWidth, int iHeight, int iPixelSize)
+{
+    size_t iTilesPerRow = (iWidth + TILE_SIZE - 1) >> TILE_SIZE_BITS;
+    size_t iTilesPerColumn = (iHeight + TILE_SIZE - 1) >> TILE_SIZE_BITS;
+    return iTilesPerRow * iTilesPerColumn * TILE_SIZE * TILE_SIZE * iPixelSize;
+}
+
+//! An image loaded from a tiled sheet file, the tiles are used directly from the mapped file.
+class TiledImage : public LoadedImage
+{
+public:
+    TiledImage(const std::string &sFilename, const std::string &sTilesFilename, unsigned long long iHash, size_t iSize);
+
+    void GetArea(int iLeft, int iTop, int iWidth, int iHeight, ImageArea *pArea) const;
+
+    FileData m_oFile;      ///< Contents of the tiled sheet file.
+    bool m_bValid;         ///< Whether the file exists, and is a tiled copy of the expected PNG file.
+    int m_iTilesPerRow;    ///< Number of tiles in a row of tiles.
+    const uint8 *m_pTiles; ///< First tile in the file.
+};
+
+//! Open a tiled sheet file.
+/*!
+    @param sFilename Filename of the PNG file.
+    @param sTilesFilename Filename of the tiled sheet file.
+    @param iHash Hash of the contents of the PNG file.
+    @param iSize Size of the PNG file.
+ */
+TiledImage::TiledImage(const std::string &sFilename, const std::string &sTilesFilename, unsigned long long iHash, size_t iSize)
+    : m_oFile(sTilesFilename, false)
+{
+    m_sFilename = sFilename;
+    m_bValid = false;
+    m_iTilesPerRow = 0;
+    m_pTiles = NULL;
+
+    const unsigned char *pData = m_oFile.m_pData;
+    if (m_oFile.m_iSize < (size_t)TILES_DATA_OFFSET || memcmp(pData, "CTTL", 4) != 0)
+        return;
+    if ((pData[12] != 1 && pData[12] != 4) || pData[13] != TILE_SIZE_BITS)
+        return;
+    if (GetLittleEndian32(pData + 16) + ((unsigned long long)GetLittleEndian32(pData + 20) << 32) != iSize)
+        return;
+    if (GetLittleEndian32(pData + 24) + ((unsigned long long)GetLittleEndian32(pData + 28) << 32) != iHash)
+        return;
+
+    m_iWidth = GetLittleEndian32(pData + 4);
+    m_iHeight = GetLittleEndian32(pData + 8);
+    m_ePixels = (pData[12] == 4) ? IP_RGBA : IP_INDEXED;
+    if (m_iWidth < 0 || m_iHeight < 0 || m_iWidth > 65535 || m_iHeight > 65535
+            || m_oFile.m_iSize < TILES_DATA_OFFSET + GetTilesSize(m_iWidth, m_iHeight, GetPixelSize()))
+        return;
+
+    m_iTilesPerRow = (m_iWidth + TILE_SIZE - 1) >> TILE_SIZE_BITS;
+    m_pTiles = pData + TILES_DATA_OFFSET;
+    m_bValid = true;
+}
+
+//! Get the pixels of a rectangular area of the image, by copying them from the tiles.
+/*!
+    @param iLeft Left-most column of the area.
+    @param iTop Top-most row of the area.
+    @param iWidth Number of columns of the area.
+    @param iHeight Number of rows of the area.
+    @param [out] pArea Pixels of the area.
+    @pre The area is inside the image.
+ */
+void TiledImage::GetArea(int iLeft, int iTop, int iWidth, int iHeight, ImageArea *pArea) const
+{
+    int iPixelSize = GetPixelSize();
+    size_t iTileBytes = TILE_SIZE * TILE_SIZE * iPixelSize;
+    size_t iRowBytes = (size_t)iWidth * iPixelSize;
+
+    pArea->m_vPixels.resize(iRowBytes * iHeight);
+    pArea->m_vRows.assign(iHeight, NULL);
+    if (pArea->m_vPixels.empty())
+        return;
+
+    uint8 *pDest = &pArea->m_vPixels[0];
+    int iEnd = iLeft + iWidth;
+    for (int y = 0; y < iHeight; y++)
+    {
+        int iRow = iTop + y;
+        const uint8 *pTileRow = m_pTiles + (size_t)(iRow >> TILE_SIZE_BITS) * m_iTilesPerRow * iTileBytes
+                                         + (size_t)(iRow & (TILE_SIZE - 1)) * TILE_SIZE * iPixelSize;
+        pArea->m_vRows[y] = pDest;
+        int x = iLeft;
+        while (x < iEnd)
+        {
+            int iCount = TILE_SIZE - (x & (TILE_SIZE - 1)); // Columns until the end of the tile.
+            if (iCount > iEnd - x)
+                iCount = iEnd - x;
+            memcpy(pDest, pTileRow + (x >> TILE_SIZE_BITS) * iTileBytes + (x & (TILE_SIZE - 1)) * iPixelSize, iCount * iPixelSize);
+            pDest += iCount * iPixelSize;
+            x += iCount;
+        }
+    }
+}
+
+//! Write a tiled sheet file of a loaded PNG file.
+/*!
+    The file is written under a temporary name first, so an interrupted write
+    does not leave a partial file in the sheet cache.
+    @param oImage Loaded image, its rows must be available.
+    @param sTilesFilename Filename of the tiled sheet file.
+    @param iHash Hash of the contents of the PNG file.
+    @param iSize Size of the PNG file.
+ */
+static void WriteTiledSheet(const LoadedImage &oImage, const std::string &sTilesFilename, unsigned long long iHash, size_t iSize)
+{
+    std::string sTempFilename = sTilesFilename + ".tmp";
+    FILE *pFile = fopen(sTempFilename.c_str(), "wb");
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Sheet cache file \"%s\" could not be opened for writing.\n", sTempFilename.c_str());
+        exit(1);
+    }
+
+    int iPixelSize = oImage.GetPixelSize();
+    std::vector<uint8> vBuffer(TILES_DATA_OFFSET, 0);
+    memcpy(&vBuffer[0], "CTTL", 4);
+    PutLittleEndian32(&vBuffer[4], oImage.m_iWidth);
+    PutLittleEndian32(&vBuffer[8], oImage.m_iHeight);
+    vBuffer[12] = iPixelSize;
+    vBuffer[13] = TILE_SIZE_BITS;
+    PutLittleEndian32(&vBuffer[16], (unsigned long long)iSize & 0xFFFFFFFF);
+    PutLittleEndian32(&vBuffer[20], (unsigned long long)iSize >> 32);
+    PutLittleEndian32(&vBuffer[24], iHash & 0xFFFFFFFF);
+    PutLittleEndian32(&vBuffer[28], iHash >> 32);
+    bool bOk = fwrite(&vBuffer[0], 1, TILES_DATA_OFFSET, pFile) == (size_t)TILES_DATA_OFFSET;
+
+    size_t iTileRowBytes = TILE_SIZE * iPixelSize;
+    for (int iTileTop = 0; bOk && iTileTop < oImage.m_iHeight; iTileTop += TILE_SIZE)
+    {
+        for (int iTileLeft = 0; bOk && iTileLeft < oImage.m_iWidth; iTileLeft += TILE_SIZE)
+        {
+            int iWidth = (oImage.m_iWidth - iTileLeft < TILE_SIZE) ? oImage.m_iWidth - iTileLeft : TILE_SIZE;
+            vBuffer.assign(TILE_SIZE * iTileRowBytes, 0);
+            for (int y = 0; y < TILE_SIZE && iTileTop + y < oImage.m_iHeight; y++)
+            {
+                memcpy(&vBuffer[y * iTileRowBytes], oImage.m_pRows[iTileTop + y] + iTileLeft * iPixelSize, iWidth * iPixelSize);
+            }
+            bOk = fwrite(&vBuffer[0], 1, vBuffer.size(), pFile) == vBuffer.size();
+        }
+    }
+
+    if (fclose(pFile) != 0 || !bOk)
+    {
+        fprintf(stderr, "Sheet cache file \"%s\" could not be written.\n", sTempFilename.c_str());
+        exit(1);
+    }
+    remove(sTilesFilename.c_str());
+    if (rename(sTempFilename.c_str(), sTilesFilename.c_str()) != 0)
+    {
+        fprintf(stderr, "Sheet cache file \"%s\" could not be renamed to \"%s\".\n", sTempFilename.c_str(), sTilesFilename.c_str());
+        exit(1);
+    }
+}
+
+//! Load a PNG file through the sheet cache.
+/*!
+    If the cache has a tiled copy of the file, that copy is used without decoding the
+    PNG file. Else the PNG file is decoded, and a tiled copy is added to the cache.
+    @param oFile Contents of the PNG file.
+    @param eWanted Wanted kind of pixels, each kind has its own tiled copy.
+    @return The loaded image.
+ */
+static LoadedImage *LoadCachedSheet(const FileData &oFile, ImagePixels eWanted)
+{
+    unsigned long long iHash = HashFileData(oFile);
+    char sName[40];
+    sprintf(sName, "%016llx-%s.tiles", iHash, (eWanted == IP_INDEXED) ? "index" : "rgba");
+    std::string sTilesFilename = g_oSettings.m_sSheetCache + "/" + sName;
+
+    TiledImage *pTiled = new TiledImage(oFile.m_sFilename, sTilesFilename, iHash, oFile.m_iSize);
+    if (pTiled->m_bValid)
+    {
+        g_oStatistics.m_iSheetCacheHits++;
+        return pTiled;
+    }
+    delete pTiled;
+
+    LoadedImage *pImage = g_oPngLoader.Load(oFile, eWanted);
+    if (pImage->m_iBitDepth == 8 && pImage->m_ePixels != IP_OTHER)
+    {
+        WriteTiledSheet(*pImage, sTilesFilename, iHash, oFile.m_iSize);
+        g_oStatistics.m_iSheetCacheWrites++;
+    }
+    return pImage;
+}
+
+//! Load an image file, selecting the loader by the first bytes of the file.
+/*!
+    @param sFilename Filename of the file to load.
+    @param eWanted Wanted kind of pixels (#IP_RGBA or #IP_INDEXED), a loader converts
+                   the pixels if its file format allows it.
+    @return The loaded image.
+ */
+LoadedImage *LoadImageFile(const std::string &sFilename, ImagePixels eWanted)
+{
+    TraceSpan oSpan("decode", sFilename);
+    const FileData *pFile = GetFileData(sFilename);
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Image file \"%s\" could not be opened.\n", sFilename.c_str());
+        exit(1);
+    }
+    if (pFile->m_iSize < 4)
+    {
+        fprintf(stderr, "Could not read header of \"%s\".\n", sFilename.c_str());
+        exit(1);
+    }
+
+    for (size_t i = 0; i < sizeof(g_aLoaders) / sizeof(g_aLoaders[0]); i++)
+    {
+        if (!g_aLoaders[i]->Matches(*pFile))
+            continue;
+
+        LoadedImage *pImage;
+        if (g_aLoaders[i] == &g_oPngLoader && !g_oSettings.m_sSheetCache.empty())
+            pImage = LoadCachedSheet(*pFile, eWanted);
+        else
+            pImage = g_aLoaders[i]->Load(*pFile, eWanted);
+        pImage->m_eWanted = eWanted;
+        oSpan.SetBytes(pFile->m_iSize);
+        return pImage;
+    }
+
+    fprintf(stderr, "Header of \"%s\" indicates it is not a PNG, QOI, or raw image file.\n", sFilename.c_str());
+    exit(1);
+}
+
+// vim: et sw=4 ts=4 sts=4
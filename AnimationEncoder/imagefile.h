@@ -0,0 +1,115 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file imagefile.h Loading of image files in the supported file formats.
+
+#ifndef IMAGEFILE_H
+#define IMAGEFILE_H
+
+#include <string>
+#include <vector>
+#include "image.h"
+
+class FileData;
+
+//! Kind of pixels of a loaded image file.
+enum ImagePixels
+{
+    IP_RGBA,    ///< Red, green, blue, and opacity channel for each pixel.
+    IP_INDEXED, ///< A palette index for each pixel.
+    IP_OTHER    ///< Any other kind of pixels (not supported by the encoder).
+};
+
+//! Pixels of a rectangular area of a loaded image.
+class ImageArea
+{
+public:
+    std::vector<const uint8 *> m_vRows; ///< Left-most pixel of the area in each row of the area.
+    std::vector<uint8> m_vPixels;       ///< Copy of the pixels of the area, if the image has no rows in memory.
+};
+
+//! A loaded image file, with the pixels of each row.
+class LoadedImage
+{
+public:
+    LoadedImage();
+    virtual ~LoadedImage();
+
+    //! Get the number of bytes of a pixel.
+    /*!
+        @return Number of bytes of a pixel.
+     */
+    int GetPixelSize() const
+    {
+        return (m_ePixels == IP_RGBA) ? 4 : 1;
+    }
+
+    virtual void GetArea(int iLeft, int iTop, int iWidth, int iHeight, ImageArea *pArea) const;
+
+    std::string m_sFilename; ///< Filename of the loaded file.
+    int m_iWidth;            ///< Width of the image in pixels.
+    int m_iHeight;           ///< Height of the image in pixels.
+    int m_iBitDepth;         ///< Number of bits of a channel.
+    ImagePixels m_ePixels;   ///< Kind of pixels.
+    ImagePixels m_eWanted;   ///< Kind of pixels asked for when loading the file.
+    uint8 **m_pRows;         ///< Rows of pixel channel information (4 bytes for an RGBA pixel, 1 byte for an index),
+                             ///< \c NULL if the pixels are only available through #GetArea.
+
+private:
+    LoadedImage(const LoadedImage &);            // Not copyable, the pixels are owned.
+    LoadedImage &operator=(const LoadedImage &);
+};
+
+//! Loader of an image file format.
+class ImageLoader
+{
+public:
+    virtual ~ImageLoader();
+
+    //! Get the name of the file format.
+    /*!
+        @return Name of the file format.
+     */
+    virtual const char *GetName() const = 0;
+
+    //! Test whether a file has this file format, from its first bytes.
+    /*!
+        @param oFile Contents of the file.
+        @return Whether the file has this format.
+     */
+    virtual bool Matches(const FileData &oFile) const = 0;
+
+    //! Load the image from a file.
+    /*!
+        @param oFile Contents of the file, has this file format.
+        @param eWanted Wanted kind of pixels, the loader may convert the pixels to it.
+        @return The loaded image.
+     */
+    virtual LoadedImage *Load(const FileData &oFile, ImagePixels eWanted) const = 0;
+};
+
+LoadedImage *LoadImageFile(const std::string &sFilename, ImagePixels eWanted);
+
+#endif
+
+// vim: et sw=4 ts=4 sts=4
@@ -28,6 +28,7 @@ SOFTWARE.
 #include "ast.h"
 #include "scanparse.h"
 #include "storage.h"
+#include "trace.h"
 
 //! Perform type checking of the parsed input.
 static void Check()
@@ -62,28 +63,199 @@ static void Check()
     {
         (*grp).second.Check();
     }
+
+    // 4. Numbered sprites, collected into the sprite table.
+    g_mapSpriteTable.clear();
+    for (NumberedSpriteIterator spr = g_vSprites.begin(); spr != g_vSprites.end(); spr++)
+    {
+        (*spr).Check();
+
+        SpriteTableIterator entry = g_mapSpriteTable.find((*spr).m_iNumber);
+        if (entry != g_mapSpriteTable.end())
+        {
+            fprintf(stderr, "Sprite at line %d: Sprite number %d is already used at line %d\n",
+                    (*spr).m_iLine, (*spr).m_iNumber, (*entry).second->m_iLine);
+            exit(1);
+        }
+        g_mapSpriteTable[(*spr).m_iNumber] = &(*spr);
+    }
 }
 
 
+//! Print how to use the program, and exit.
+static void Usage()
+{
+    printf("Usage: encode [options] <animation-file> <output-file>\n"
+           "\n"
+           "Options:\n"
+           "  --row-table  Store a row offset table with each sprite\n"
+           "  --long-runs  Allow runs of pixels longer than 63 pixels\n"
+           "  --rgba-runs  Allow runs of pixels with an opacity for each pixel\n"
+           "  --fill-runs  Allow runs of pixels with a single colour\n"
+           "  --palette    Store the colours of a sprite in a palette if it is smaller\n"
+           "  --optimal    Select the runs of pixels with the smallest total size\n"
+           "  --flip-sprites\n"
+           "               Store a sprite that is a mirror image of an earlier sprite\n"
+           "               as a flipped reference to that sprite\n"
+           "  --alpha-snap <n>\n"
+           "               Make opacities within <n> of fully transparent or fully opaque\n"
+           "               fully transparent or fully opaque (default 0)\n"
+           "  --alpha-step <n>\n"
+           "               Round other partial opacities to a multiple of <n> (default 1)\n"
+           "  --opacity-plane\n"
+           "               Keep the opacity of a sprite in a separate plane while encoding\n"
+           "  --prefetch <n>\n"
+           "               Read up to <n> image files ahead of the encoder (default 0)\n"
+           "  --no-mmap    Read the image files instead of mapping them into memory\n"
+           "  --sheet-cache <directory>\n"
+           "               Keep a tiled copy of each loaded PNG file in <directory>,\n"
+           "               and load it instead of decoding the PNG file again\n"
+           "  --share-frames\n"
+           "               Refer to the written frames of an animation with the same frames\n"
+           "  --tile-atlas <name>\n"
+           "               Write the numbered sprites into atlas images <name>-N.png,\n"
+           "               with their positions in <name>.txt\n"
+           "  --atlas <name>\n"
+           "               Store all sprites in atlas images <name>-N.png instead of\n"
+           "               sprite blocks\n"
+           "  --atlas-size <size>\n"
+           "               Maximal width and height of an atlas image (default 2048)\n"
+           "  --atlas-padding <pixels>\n"
+           "               Transparent pixels around each sprite in an atlas (default 1)\n"
+           "  --atlas-raw  Write atlas images as raw RGBA pixels (<name>-N.rgba)\n"
+           "  --verify     Decode each encoded sprite, and compare it with its images\n"
+           "  --stats      Print statistics of the output\n"
+           "  --report <file>\n"
+           "               Write the size of each animation group to <file>, as JSON\n"
+           "               if <file> ends with .json, else as CSV\n"
+           "  --trace <file>\n"
+           "               Write the time spent in the steps of the encoder to <file>,\n"
+           "               as trace events for Chrome or Perfetto\n"
+           "  -h, --help   Display this help\n");
+    exit(1);
+}
+
+//! Get the numeric value of an option.
+/*!
+    @param sOption Name of the option.
+    @param sValue Value of the option.
+    @param iMin Smallest allowed value.
+    @param iMax Biggest allowed value.
+    @return The value of the option.
+ */
+static int GetNumberOption(const char *sOption, const char *sValue, int iMin, int iMax)
+{
+    char *pEnd;
+    long iValue = strtol(sValue, &pEnd, 10);
+    if (*sValue == '\0' || *pEnd != '\0' || iValue < iMin || iValue > iMax)
+    {
+        fprintf(stderr, "Value of option %s must be a number between %d and %d.\n", sOption, iMin, iMax);
+        exit(1);
+    }
+    return iValue;
+}
+
 int main(int iArgc, char *pArgv[])
 {
     // Perform argument processing.
-    if (iArgc == 1)
+    int iArg = 1;
+    while (iArg < iArgc && pArgv[iArg][0] == '-')
     {
-        SetupScanner(NULL, NULL);
+        if (strcmp(pArgv[iArg], "--row-table") == 0)
+            g_oSettings.m_bRowTable = true;
+        else if (strcmp(pArgv[iArg], "--long-runs") == 0)
+            g_oSettings.m_bLongRuns = true;
+        else if (strcmp(pArgv[iArg], "--rgba-runs") == 0)
+            g_oSettings.m_bRgbaRuns = true;
+        else if (strcmp(pArgv[iArg], "--fill-runs") == 0)
+            g_oSettings.m_bFillRuns = true;
+        else if (strcmp(pArgv[iArg], "--palette") == 0)
+            g_oSettings.m_bPalette = true;
+        else if (strcmp(pArgv[iArg], "--optimal") == 0)
+            g_oSettings.m_bOptimal = true;
+        else if (strcmp(pArgv[iArg], "--flip-sprites") == 0)
+            g_oSettings.m_bFlipSprites = true;
+        else if (strcmp(pArgv[iArg], "--opacity-plane") == 0)
+            g_oSettings.m_bOpacityPlane = true;
+        else if (strcmp(pArgv[iArg], "--share-frames") == 0)
+            g_oSettings.m_bShareFrames = true;
+        else if (strcmp(pArgv[iArg], "--tile-atlas") == 0 && iArg + 1 < iArgc)
+            g_oSettings.m_sTileAtlas = pArgv[++iArg];
+        else if (strcmp(pArgv[iArg], "--sheet-cache") == 0 && iArg + 1 < iArgc)
+            g_oSettings.m_sSheetCache = pArgv[++iArg];
+        else if (strcmp(pArgv[iArg], "--atlas") == 0 && iArg + 1 < iArgc)
+            g_oSettings.m_sAtlas = pArgv[++iArg];
+        else if (strcmp(pArgv[iArg], "--atlas-size") == 0 && iArg + 1 < iArgc)
+        {
+            g_oSettings.m_iAtlasSize = GetNumberOption(pArgv[iArg], pArgv[iArg + 1], 64, 16384);
+            if ((g_oSettings.m_iAtlasSize & (g_oSettings.m_iAtlasSize - 1)) != 0)
+            {
+                fprintf(stderr, "Value of option --atlas-size must be a power of two.\n");
+                exit(1);
+            }
+            iArg++;
+        }
+        else if (strcmp(pArgv[iArg], "--alpha-snap") == 0 && iArg + 1 < iArgc)
+        {
+            g_oSettings.m_iAlphaSnap = GetNumberOption(pArgv[iArg], pArgv[iArg + 1], 0, 127);
+            iArg++;
+        }
+        else if (strcmp(pArgv[iArg], "--alpha-step") == 0 && iArg + 1 < iArgc)
+        {
+            g_oSettings.m_iAlphaStep = GetNumberOption(pArgv[iArg], pArgv[iArg + 1], 1, 128);
+            iArg++;
+        }
+        else if (strcmp(pArgv[iArg], "--no-mmap") == 0)
+            g_oSettings.m_bMapFiles = false;
+        else if (strcmp(pArgv[iArg], "--prefetch") == 0 && iArg + 1 < iArgc)
+        {
+            g_oSettings.m_iPrefetch = GetNumberOption(pArgv[iArg], pArgv[iArg + 1], 0, 1024);
+            iArg++;
+        }
+        else if (strcmp(pArgv[iArg], "--atlas-padding") == 0 && iArg + 1 < iArgc)
+        {
+            g_oSettings.m_iAtlasPadding = GetNumberOption(pArgv[iArg], pArgv[iArg + 1], 0, 16);
+            iArg++;
+        }
+        else if (strcmp(pArgv[iArg], "--atlas-raw") == 0)
+            g_oSettings.m_bAtlasRaw = true;
+        else if (strcmp(pArgv[iArg], "--verify") == 0)
+            g_oSettings.m_bVerify = true;
+        else if (strcmp(pArgv[iArg], "--stats") == 0)
+            g_oSettings.m_bStats = true;
+        else if (strcmp(pArgv[iArg], "--report") == 0 && iArg + 1 < iArgc)
+            g_oSettings.m_sReport = pArgv[++iArg];
+        else if (strcmp(pArgv[iArg], "--trace") == 0 && iArg + 1 < iArgc)
+            g_oSettings.m_sTrace = pArgv[++iArg];
+        else
+            Usage();
+
+        iArg++;
     }
-    else if (iArgc != 3 || strcmp(pArgv[1], "-h") == 0 || strcmp(pArgv[1], "--help") == 0)
+    if (iArgc - iArg != 2)
+        Usage();
+    if (g_oSettings.m_sReport != "" && g_oSettings.m_sAtlas != "")
     {
-        printf("Usage: encode <animation-file> <output-file>\n");
+        // The sprite data of the report is not written with an atlas.
+        fprintf(stderr, "Options --report and --atlas cannot be used together.\n");
         exit(1);
     }
+    if (!g_oSettings.m_sTrace.empty())
+        StartTrace(g_oSettings.m_sTrace);
 
-    FILE *pInfile = fopen(pArgv[1], "r");
-    SetupScanner(pArgv[1], pInfile);
+    FILE *pInfile = fopen(pArgv[iArg], "r");
+    if (pInfile == NULL)
+    {
+        fprintf(stderr, "Animation file \"%s\" could not be opened.\n", pArgv[iArg]);
+        exit(1);
+    }
+    SetupScanner(pArgv[iArg], pInfile);
 
     // Parse input file.
+    TraceSpan oParse("parse", pArgv[iArg]);
     int iRet = yyparse();
-    if (pInfile != NULL) fclose(pInfile);
+    fclose(pInfile);
+    oParse.Close();
 
     if (iRet != 0)
     {
@@ -91,9 +263,15 @@ int main(int iArgc, char *pArgv[])
     }
 
     // Check input, generate output.
+    TraceSpan oCheck("check");
     Check();
-    Encode(pArgv[2]);
+    oCheck.Close();
+
+    TraceSpan oEncode("encode", pArgv[iArg + 1]);
+    Encode(pArgv[iArg + 1]);
+    oEncode.Close();
 
+    StopTrace();
     exit(0);
 }
 
@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2012 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.7"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,8 +66,7 @@
 
 
 
-/* Copy the first part of user declarations.  */
-/* Line 371 of yacc.c  */
+/* First part of user prologue.  */
 #line 23 "parser.y"
 
 #include <cstdio>
@@ -70,135 +74,174 @@
 #include "scanparse.h"
 
 std::vector<Animation> g_vAnimations;
+std::vector<NumberedSprite> g_vSprites;
 
-/* Line 371 of yacc.c  */
-#line 76 "parser.cpp"
+#line 80 "parser.cpp"
 
-# ifndef YY_NULL
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULL nullptr
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
 #  else
-#   define YY_NULL 0
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
+#include "tokens.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_CURLY_OPEN = 3,                 /* CURLY_OPEN  */
+  YYSYMBOL_CURLY_CLOSE = 4,                /* CURLY_CLOSE  */
+  YYSYMBOL_EQUAL = 5,                      /* EQUAL  */
+  YYSYMBOL_SEMICOL = 6,                    /* SEMICOL  */
+  YYSYMBOL_LEFTKW = 7,                     /* LEFTKW  */
+  YYSYMBOL_TOPKW = 8,                      /* TOPKW  */
+  YYSYMBOL_WIDTHKW = 9,                    /* WIDTHKW  */
+  YYSYMBOL_HEIGHTKW = 10,                  /* HEIGHTKW  */
+  YYSYMBOL_BASE_IMGKW = 11,                /* BASE_IMGKW  */
+  YYSYMBOL_RECOLOURKW = 12,                /* RECOLOURKW  */
+  YYSYMBOL_LAYERKW = 13,                   /* LAYERKW  */
+  YYSYMBOL_ALPHAKW = 14,                   /* ALPHAKW  */
+  YYSYMBOL_HOR_FLIPKW = 15,                /* HOR_FLIPKW  */
+  YYSYMBOL_VERT_FLIPKW = 16,               /* VERT_FLIPKW  */
+  YYSYMBOL_X_OFFSETKW = 17,                /* X_OFFSETKW  */
+  YYSYMBOL_Y_OFFSETKW = 18,                /* Y_OFFSETKW  */
+  YYSYMBOL_ANIMATIONKW = 19,               /* ANIMATIONKW  */
+  YYSYMBOL_FRAMEKW = 20,                   /* FRAMEKW  */
+  YYSYMBOL_TILE_SIZEKW = 21,               /* TILE_SIZEKW  */
+  YYSYMBOL_VIEWKW = 22,                    /* VIEWKW  */
+  YYSYMBOL_SOUNDKW = 23,                   /* SOUNDKW  */
+  YYSYMBOL_NORTHKW = 24,                   /* NORTHKW  */
+  YYSYMBOL_WESTKW = 25,                    /* WESTKW  */
+  YYSYMBOL_SOUTHKW = 26,                   /* SOUTHKW  */
+  YYSYMBOL_EASTKW = 27,                    /* EASTKW  */
+  YYSYMBOL_ELEMENTKW = 28,                 /* ELEMENTKW  */
+  YYSYMBOL_DISPLAYKW = 29,                 /* DISPLAYKW  */
+  YYSYMBOL_SPRITEKW = 30,                  /* SPRITEKW  */
+  YYSYMBOL_NUMBER = 31,                    /* NUMBER  */
+  YYSYMBOL_STRING = 32,                    /* STRING  */
+  YYSYMBOL_YYACCEPT = 33,                  /* $accept  */
+  YYSYMBOL_Program = 34,                   /* Program  */
+  YYSYMBOL_Animation = 35,                 /* Animation  */
+  YYSYMBOL_Sprite = 36,                    /* Sprite  */
+  YYSYMBOL_AnimationProperties = 37,       /* AnimationProperties  */
+  YYSYMBOL_AnimationProperty = 38,         /* AnimationProperty  */
+  YYSYMBOL_Direction = 39,                 /* Direction  */
+  YYSYMBOL_AnimationFrames = 40,           /* AnimationFrames  */
+  YYSYMBOL_AnimationFrame = 41,            /* AnimationFrame  */
+  YYSYMBOL_FrameProperty = 42,             /* FrameProperty  */
+  YYSYMBOL_FrameElements = 43,             /* FrameElements  */
+  YYSYMBOL_FrameElement = 44,              /* FrameElement  */
+  YYSYMBOL_ElementFields = 45,             /* ElementFields  */
+  YYSYMBOL_ElementField = 46               /* ElementField  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
 
-/* In a future release of Bison, this section will be replaced
-   by #include "tokens.h".  */
-#ifndef YY_YY_TOKENS_H_INCLUDED
-# define YY_YY_TOKENS_H_INCLUDED
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
 
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     CURLY_OPEN = 258,
-     CURLY_CLOSE = 259,
-     EQUAL = 260,
-     SEMICOL = 261,
-     LEFTKW = 262,
-     TOPKW = 263,
-     WIDTHKW = 264,
-     HEIGHTKW = 265,
-     BASE_IMGKW = 266,
-     RECOLOURKW = 267,
-     LAYERKW = 268,
-     ALPHAKW = 269,
-     HOR_FLIPKW = 270,
-     VERT_FLIPKW = 271,
-     X_OFFSETKW = 272,
-     Y_OFFSETKW = 273,
-     ANIMATIONKW = 274,
-     FRAMEKW = 275,
-     TILE_SIZEKW = 276,
-     VIEWKW = 277,
-     SOUNDKW = 278,
-     NORTHKW = 279,
-     WESTKW = 280,
-     SOUTHKW = 281,
-     EASTKW = 282,
-     ELEMENTKW = 283,
-     DISPLAYKW = 284,
-     NUMBER = 285,
-     STRING = 286
-   };
-#endif
 
+#ifdef short
+# undef short
+#endif
 
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-extern YYSTYPE yylval;
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
 #else
-int yyparse ();
+typedef signed char yytype_int8;
 #endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-int yyparse ();
+typedef short yytype_int16;
 #endif
-#endif /* ! YYPARSE_PARAM */
-
-#endif /* !YY_YY_TOKENS_H_INCLUDED  */
-
-/* Copy the second part of user declarations.  */
-
-/* Line 390 of yacc.c  */
-#line 172 "parser.cpp"
 
-#ifdef short
-# undef short
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
 typedef unsigned char yytype_uint8;
-#endif
-
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-typedef signed char yytype_int8;
 #else
-typedef short int yytype_int8;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef unsigned short int yytype_uint16;
+typedef int yytype_uint16;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
-#else
-typedef short int yytype_int16;
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -206,16 +249,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -229,32 +284,71 @@ typedef short int yytype_int16;
 # endif
 #endif
 
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(N) (N)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int yyi)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (yyi)
-    int yyi;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return yyi;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
 #endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -271,8 +365,7 @@ YYID (yyi)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
       /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
 #     ifndef EXIT_SUCCESS
@@ -284,8 +377,8 @@ YYID (yyi)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -301,7 +394,7 @@ YYID (yyi)
 #  endif
 #  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
 #   ifndef EXIT_SUCCESS
 #    define EXIT_SUCCESS 0
@@ -309,40 +402,37 @@ YYID (yyi)
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -352,16 +442,16 @@ union yyalloc
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack_alloc, Stack)				\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack_alloc, Stack, yysize);			\
-	Stack = &yyptr->Stack_alloc;					\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
@@ -371,16 +461,16 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
-      while (YYID (0))
+      while (0)
 #  endif
 # endif
 #endif /* !YYCOPY_NEEDED */
@@ -388,26 +478,31 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  2
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   103
+#define YYLAST   114
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  32
+#define YYNTOKENS  33
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  13
+#define YYNNTS  14
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  35
-/* YYNRULES -- Number of states.  */
-#define YYNSTATES  91
+#define YYNRULES  37
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  97
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   287
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   286
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -437,260 +532,212 @@ static const yytype_uint8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
-      25,    26,    27,    28,    29,    30,    31
+      25,    26,    27,    28,    29,    30,    31,    32
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     4,     7,    14,    16,    19,    24,    29,
-      31,    33,    35,    37,    39,    42,    48,    49,    54,    56,
-      59,    64,    66,    69,    74,    79,    84,    89,    94,    99,
-     104,   109,   115,   121,   126,   128
+       0,    58,    58,    62,    66,    72,    81,    89,    95,   102,
+     107,   114,   119,   124,   129,   136,   142,   149,   159,   163,
+     170,   176,   183,   191,   197,   204,   209,   214,   219,   224,
+     229,   234,   239,   244,   249,   254,   259,   264
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      33,     0,    -1,    -1,    33,    34,    -1,    19,    31,     3,
-      35,    38,     4,    -1,    36,    -1,    35,    36,    -1,    21,
-       5,    30,     6,    -1,    22,     5,    37,     6,    -1,    24,
-      -1,    27,    -1,    26,    -1,    25,    -1,    39,    -1,    38,
-      39,    -1,    20,     3,    40,    41,     4,    -1,    -1,    23,
-       5,    30,     6,    -1,    42,    -1,    41,    42,    -1,    28,
-       3,    43,     4,    -1,    44,    -1,    43,    44,    -1,     8,
-       5,    30,     6,    -1,     7,     5,    30,     6,    -1,     9,
-       5,    30,     6,    -1,    10,     5,    30,     6,    -1,    17,
-       5,    30,     6,    -1,    18,     5,    30,     6,    -1,    11,
-       5,    31,     6,    -1,    12,     5,    31,     6,    -1,    13,
-      30,     5,    30,     6,    -1,    29,    30,     5,    30,     6,
-      -1,    14,     5,    30,     6,    -1,    15,    -1,    16,    -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint8 yyrline[] =
-{
-       0,    56,    56,    59,    65,    74,    80,    87,    92,    99,
-     104,   109,   114,   121,   127,   134,   144,   148,   155,   161,
-     168,   176,   182,   189,   194,   199,   204,   209,   214,   219,
-     224,   229,   234,   239,   244,   249
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "CURLY_OPEN", "CURLY_CLOSE", "EQUAL",
-  "SEMICOL", "LEFTKW", "TOPKW", "WIDTHKW", "HEIGHTKW", "BASE_IMGKW",
-  "RECOLOURKW", "LAYERKW", "ALPHAKW", "HOR_FLIPKW", "VERT_FLIPKW",
-  "X_OFFSETKW", "Y_OFFSETKW", "ANIMATIONKW", "FRAMEKW", "TILE_SIZEKW",
-  "VIEWKW", "SOUNDKW", "NORTHKW", "WESTKW", "SOUTHKW", "EASTKW",
-  "ELEMENTKW", "DISPLAYKW", "NUMBER", "STRING", "$accept", "Program",
-  "Animation", "AnimationProperties", "AnimationProperty", "Direction",
+  "\"end of file\"", "error", "\"invalid token\"", "CURLY_OPEN",
+  "CURLY_CLOSE", "EQUAL", "SEMICOL", "LEFTKW", "TOPKW", "WIDTHKW",
+  "HEIGHTKW", "BASE_IMGKW", "RECOLOURKW", "LAYERKW", "ALPHAKW",
+  "HOR_FLIPKW", "VERT_FLIPKW", "X_OFFSETKW", "Y_OFFSETKW", "ANIMATIONKW",
+  "FRAMEKW", "TILE_SIZEKW", "VIEWKW", "SOUNDKW", "NORTHKW", "WESTKW",
+  "SOUTHKW", "EASTKW", "ELEMENTKW", "DISPLAYKW", "SPRITEKW", "NUMBER",
+  "STRING", "$accept", "Program", "Animation", "Sprite",
+  "AnimationProperties", "AnimationProperty", "Direction",
   "AnimationFrames", "AnimationFrame", "FrameProperty", "FrameElements",
-  "FrameElement", "ElementFields", "ElementField", YY_NULL
+  "FrameElement", "ElementFields", "ElementField", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-29)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
 {
-       0,    32,    33,    33,    34,    35,    35,    36,    36,    37,
-      37,    37,    37,    38,    38,    39,    40,    40,    41,    41,
-      42,    43,    43,    44,    44,    44,    44,    44,    44,    44,
-      44,    44,    44,    44,    44,    44
+     -29,     1,   -29,    -7,    -5,   -29,   -29,    27,    44,    -4,
+      48,    43,    45,    24,   -29,    46,    47,    63,    64,    65,
+      66,    18,    67,   -29,   -29,    68,    69,    22,    -2,   -29,
+      49,    -3,    72,   -29,    -1,   -29,    50,    51,    52,    53,
+      54,    55,    71,    57,    58,    59,    73,   -29,   -29,    79,
+     -29,   -29,   -29,   -29,    85,    56,   -29,   -29,    86,    87,
+      88,    89,    90,    91,    70,    92,    93,    94,    74,   -29,
+     -29,    97,    75,   -29,   -29,   -29,   -29,   -29,   -29,    98,
+     -29,   -29,   -29,   100,    76,   105,     0,   -29,   -29,   -29,
+     103,    48,   -29,   -29,   -29,    25,   -29
 };
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       0,     2,     0,     2,     6,     1,     2,     4,     4,     1,
-       1,     1,     1,     1,     2,     5,     0,     4,     1,     2,
-       4,     1,     2,     4,     4,     4,     4,     4,     4,     4,
-       4,     5,     5,     4,     1,     1
+       2,     0,     1,     0,     0,     3,     4,     0,     0,     0,
+       0,     0,     0,     0,     7,     0,     0,     0,     0,     0,
+       0,     0,     0,    36,    37,     0,     0,     0,     0,    23,
+       0,     0,     0,     8,     0,    15,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     6,    24,     0,
+      11,    14,    13,    12,     0,    18,     5,    16,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     9,
+      10,     0,     0,    26,    25,    27,    28,    31,    32,     0,
+      35,    29,    30,     0,     0,     0,     0,    20,    33,    34,
+       0,     0,    17,    21,    19,     0,    22
 };
 
-/* YYDEFACT[STATE-NAME] -- Default reduction number in state STATE-NUM.
-   Performed when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
 {
-       2,     0,     1,     0,     3,     0,     0,     0,     0,     0,
-       5,     0,     0,     0,     6,     0,    13,     0,     9,    12,
-      11,    10,     0,    16,     4,    14,     7,     8,     0,     0,
-       0,     0,     0,    18,     0,     0,    15,    19,    17,     0,
-       0,     0,     0,     0,     0,     0,     0,    34,    35,     0,
-       0,     0,     0,    21,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,    20,    22,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,    24,    23,
-      25,    26,    29,    30,     0,    33,    27,    28,     0,    31,
-      32
+     -29,   -29,   -29,   -29,   -29,    99,   -29,   -29,    77,   -29,
+     -29,    28,    19,   -28
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     1,     4,     9,    10,    22,    15,    16,    29,    32,
-      33,    52,    53
+       0,     1,     5,     6,    13,    14,    54,    34,    35,    72,
+      86,    87,    28,    29
 };
 
-/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-   STATE-NUM.  */
-#define YYPACT_NINF -13
-static const yytype_int8 yypact[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
 {
-     -13,     1,   -13,   -12,   -13,    37,     0,    39,    40,    21,
-     -13,    -6,    -9,    43,   -13,    19,   -13,    41,   -13,   -13,
-     -13,   -13,    42,    27,   -13,   -13,   -13,   -13,    46,    24,
-      23,    51,    -2,   -13,    49,    20,   -13,   -13,   -13,    52,
-      53,    54,    55,    56,    57,    26,    58,   -13,   -13,    59,
-      60,    36,    -4,   -13,    38,    44,    45,    47,    48,    50,
-      62,    61,    63,    64,    65,   -13,   -13,    66,    67,    70,
-      72,    74,    76,    68,    77,    78,    79,    69,   -13,   -13,
-     -13,   -13,   -13,   -13,    80,   -13,   -13,   -13,    81,   -13,
-     -13
+      48,     2,    47,    56,    92,    15,    16,    17,    18,    19,
+      20,    21,    22,    23,    24,    25,    26,    11,    12,    32,
+       3,    50,    51,    52,    53,     7,     8,    27,    85,    96,
+       9,     4,    15,    16,    17,    18,    19,    20,    21,    22,
+      23,    24,    25,    26,    32,    11,    12,    10,    30,    42,
+      31,    36,    37,    46,    27,    15,    16,    17,    18,    19,
+      20,    21,    22,    23,    24,    25,    26,    48,    38,    39,
+      40,    41,    43,    44,    45,    55,    64,    27,    68,    71,
+      49,    58,    59,    60,    61,    69,    62,    63,    65,    66,
+      67,    70,    73,    74,    75,    76,    77,    78,    80,    81,
+      82,    79,    84,    85,    88,    83,    89,    90,    91,    94,
+      95,    57,    33,     0,    93
 };
 
-/* YYPGOTO[NTERM-NUM].  */
-static const yytype_int8 yypgoto[] =
+static const yytype_int8 yycheck[] =
 {
-     -13,   -13,   -13,   -13,    83,   -13,   -13,    73,   -13,   -13,
-      71,   -13,    17
+      28,     0,     4,     4,     4,     7,     8,     9,    10,    11,
+      12,    13,    14,    15,    16,    17,    18,    21,    22,    20,
+      19,    24,    25,    26,    27,    32,    31,    29,    28,     4,
+       3,    30,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    20,    21,    22,     3,     5,    31,
+       5,     5,     5,    31,    29,     7,     8,     9,    10,    11,
+      12,    13,    14,    15,    16,    17,    18,    95,     5,     5,
+       5,     5,     5,     5,     5,     3,     5,    29,     5,    23,
+      31,    31,    31,    31,    31,     6,    32,    32,    31,    31,
+      31,     6,     6,     6,     6,     6,     6,     6,     6,     6,
+       6,    31,     5,    28,     6,    31,     6,    31,     3,     6,
+      91,    34,    13,    -1,    86
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
-static const yytype_uint8 yytable[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-      65,     2,    36,    39,    40,    41,    42,    43,    44,    45,
-      46,    47,    48,    49,    50,    18,    19,    20,    21,     5,
-       3,     7,     8,    24,    17,    51,    31,    39,    40,    41,
-      42,    43,    44,    45,    46,    47,    48,    49,    50,    13,
-       6,    13,     7,     8,    11,    12,    23,    26,    27,    51,
-      28,    30,    31,    34,    35,    38,    60,    54,    55,    56,
-      57,    58,    59,    61,    62,    63,    64,    73,    67,    66,
-      77,     0,    78,    79,    68,    69,    80,    70,    81,    71,
-      82,    72,    83,    85,    86,    87,    89,    90,    25,     0,
-       0,    74,    14,    75,    76,     0,     0,     0,    84,    88,
-       0,     0,     0,    37
+       0,    34,     0,    19,    30,    35,    36,    32,    31,     3,
+       3,    21,    22,    37,    38,     7,     8,     9,    10,    11,
+      12,    13,    14,    15,    16,    17,    18,    29,    45,    46,
+       5,     5,    20,    38,    40,    41,     5,     5,     5,     5,
+       5,     5,    31,     5,     5,     5,    31,     4,    46,    31,
+      24,    25,    26,    27,    39,     3,     4,    41,    31,    31,
+      31,    31,    32,    32,     5,    31,    31,    31,     5,     6,
+       6,    23,    42,     6,     6,     6,     6,     6,     6,    31,
+       6,     6,     6,    31,     5,    28,    43,    44,     6,     6,
+      31,     3,     4,    44,     6,    45,     4
 };
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-13)))
-
-#define yytable_value_is_error(Yytable_value) \
-  YYID (0)
-
-static const yytype_int8 yycheck[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       4,     0,     4,     7,     8,     9,    10,    11,    12,    13,
-      14,    15,    16,    17,    18,    24,    25,    26,    27,    31,
-      19,    21,    22,     4,    30,    29,    28,     7,     8,     9,
-      10,    11,    12,    13,    14,    15,    16,    17,    18,    20,
-       3,    20,    21,    22,     5,     5,     3,     6,     6,    29,
-      23,     5,    28,    30,     3,     6,    30,     5,     5,     5,
-       5,     5,     5,     5,     5,     5,    30,     5,    30,    52,
-       5,    -1,     6,     6,    30,    30,     6,    30,     6,    31,
-       6,    31,     6,     6,     6,     6,     6,     6,    15,    -1,
-      -1,    30,     9,    30,    30,    -1,    -1,    -1,    30,    30,
-      -1,    -1,    -1,    32
+       0,    33,    34,    34,    34,    35,    36,    37,    37,    38,
+      38,    39,    39,    39,    39,    40,    40,    41,    42,    42,
+      43,    43,    44,    45,    45,    46,    46,    46,    46,    46,
+      46,    46,    46,    46,    46,    46,    46,    46
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,    33,     0,    19,    34,    31,     3,    21,    22,    35,
-      36,     5,     5,    20,    36,    38,    39,    30,    24,    25,
-      26,    27,    37,     3,     4,    39,     6,     6,    23,    40,
-       5,    28,    41,    42,    30,     3,     4,    42,     6,     7,
-       8,     9,    10,    11,    12,    13,    14,    15,    16,    17,
-      18,    29,    43,    44,     5,     5,     5,     5,     5,     5,
-      30,     5,     5,     5,    30,     4,    44,    30,    30,    30,
-      30,    31,    31,     5,    30,    30,    30,     5,     6,     6,
-       6,     6,     6,     6,    30,     6,     6,     6,    30,     6,
-       6
+       0,     2,     0,     2,     2,     6,     5,     1,     2,     4,
+       4,     1,     1,     1,     1,     1,     2,     5,     0,     4,
+       1,     2,     4,     1,     2,     4,     4,     4,     4,     4,
+       4,     4,     4,     5,     5,     4,     1,     1
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
-
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
-
-
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  However,
-   YYFAIL appears to be in use.  Nevertheless, it is formally deprecated
-   in Bison 2.4.2's NEWS entry, where a plan to phase it out is
-   discussed.  */
-
-#define YYFAIL		goto yyerrlab
-#if defined YYFAIL
-  /* This is here to suppress warnings from the GCC cpp's
-     -Wunused-macros.  Normally we don't worry about that warning, but
-     some users do, and we want to make it easy for users to remove
-     YYFAIL uses, which will produce warnings from Bison 2.5.  */
-#endif
 
-#define YYRECOVERING()  (!!yyerrstatus)
+enum { YYENOMEM = -2 };
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-/* Error token number */
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -700,82 +747,58 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-        break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
 static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -783,16 +806,8 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
-#else
-static void
-yy_stack_print (yybottom, yytop)
-    yytype_int16 *yybottom;
-    yytype_int16 *yytop;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -803,63 +818,56 @@ yy_stack_print (yybottom, yytop)
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
-static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
       YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -875,363 +883,77 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
 
-  if (! yyres)
-    return yystrlen (yystr);
 
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULL, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULL;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - Assume YYFAIL is not used.  It's too flawed to consider.  See
-       <http://lists.gnu.org/archive/html/bison-patches/2009-12/msg00024.html>
-       for details.  YYERROR is fine as it does not invoke this
-       function.
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULL, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
-    }
 
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
-
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
-  }
-
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
 static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
 {
-  YYUSE (yyvaluep);
-
+  YY_USE (yyvaluep);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-  switch (yytype)
-    {
-
-      default:
-        break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
-
-#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END
-#endif
-#ifndef YY_INITIAL_VALUE
-# define YY_INITIAL_VALUE(Value) /* Nothing. */
-#endif
-
 /* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval YY_INITIAL_VALUE(yyval_default);
-
+YYSTYPE yylval;
 /* Number of syntax errors so far.  */
 int yynerrs;
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 int
 yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       `yyss': related to states.
-       `yyvs': related to semantic values.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1239,102 +961,107 @@ yyparse ()
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss_alloc, yyss);
-	YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1345,18 +1072,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1384,15 +1122,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1407,14 +1143,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1427,322 +1163,341 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-/* Line 1792 of yacc.c  */
-#line 56 "parser.y"
-    {
+  case 2: /* Program: %empty  */
+#line 58 "parser.y"
+          {
               g_vAnimations.clear();
+              g_vSprites.clear();
           }
+#line 1173 "parser.cpp"
     break;
 
-  case 3:
-/* Line 1792 of yacc.c  */
-#line 60 "parser.y"
-    {
-              g_vAnimations.push_back((yyvsp[(2) - (2)].m_oAnimation));
+  case 3: /* Program: Program Animation  */
+#line 63 "parser.y"
+          {
+              g_vAnimations.push_back((yyvsp[0].m_oAnimation));
           }
+#line 1181 "parser.cpp"
     break;
 
-  case 4:
-/* Line 1792 of yacc.c  */
-#line 66 "parser.y"
-    {
-                Animation an((yyvsp[(1) - (6)].m_iLine), (yyvsp[(2) - (6)].m_sText));
-                an.SetProperties((yyvsp[(4) - (6)].m_vFields));
-                an.SetFrames((yyvsp[(5) - (6)].m_vFrames));
+  case 4: /* Program: Program Sprite  */
+#line 67 "parser.y"
+          {
+              g_vSprites.push_back((yyvsp[0].m_oSprite));
+          }
+#line 1189 "parser.cpp"
+    break;
+
+  case 5: /* Animation: ANIMATIONKW STRING CURLY_OPEN AnimationProperties AnimationFrames CURLY_CLOSE  */
+#line 73 "parser.y"
+            {
+                Animation an((yyvsp[-5].m_iLine), (yyvsp[-4].m_sText));
+                an.SetProperties((yyvsp[-2].m_vFields));
+                an.SetFrames((yyvsp[-1].m_vFrames));
                 (yyval.m_oAnimation) = an;
             }
+#line 1200 "parser.cpp"
     break;
 
-  case 5:
-/* Line 1792 of yacc.c  */
-#line 75 "parser.y"
-    {
+  case 6: /* Sprite: SPRITEKW NUMBER CURLY_OPEN ElementFields CURLY_CLOSE  */
+#line 82 "parser.y"
+         {
+             NumberedSprite ns((yyvsp[-4].m_iLine), (yyvsp[-3].m_iNumber));
+             ns.SetProperties((yyvsp[-1].m_vFields));
+             (yyval.m_oSprite) = ns;
+         }
+#line 1210 "parser.cpp"
+    break;
+
+  case 7: /* AnimationProperties: AnimationProperty  */
+#line 90 "parser.y"
+                      {
                           std::vector<FieldStorage> fss;
                           (yyval.m_vFields) = fss;
-                          (yyval.m_vFields).push_back((yyvsp[(1) - (1)].m_oField));
+                          (yyval.m_vFields).push_back((yyvsp[0].m_oField));
                       }
+#line 1220 "parser.cpp"
     break;
 
-  case 6:
-/* Line 1792 of yacc.c  */
-#line 81 "parser.y"
-    {
-                          (yyval.m_vFields) = (yyvsp[(1) - (2)].m_vFields);
-                          (yyval.m_vFields).push_back((yyvsp[(2) - (2)].m_oField));
+  case 8: /* AnimationProperties: AnimationProperties AnimationProperty  */
+#line 96 "parser.y"
+                      {
+                          (yyval.m_vFields) = (yyvsp[-1].m_vFields);
+                          (yyval.m_vFields).push_back((yyvsp[0].m_oField));
                       }
+#line 1229 "parser.cpp"
     break;
 
-  case 7:
-/* Line 1792 of yacc.c  */
-#line 88 "parser.y"
-    {
-                        FieldStorage fs(AP_TILESIZE, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 9: /* AnimationProperty: TILE_SIZEKW EQUAL NUMBER SEMICOL  */
+#line 103 "parser.y"
+                    {
+                        FieldStorage fs(AP_TILESIZE, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                         (yyval.m_oField) = fs;
                     }
+#line 1238 "parser.cpp"
     break;
 
-  case 8:
-/* Line 1792 of yacc.c  */
-#line 93 "parser.y"
-    {
-                        (yyval.m_oField) = (yyvsp[(3) - (4)].m_oField);
-                        (yyval.m_oField).m_iLine = (yyvsp[(1) - (4)].m_iLine);
+  case 10: /* AnimationProperty: VIEWKW EQUAL Direction SEMICOL  */
+#line 108 "parser.y"
+                    {
+                        (yyval.m_oField) = (yyvsp[-1].m_oField);
+                        (yyval.m_oField).m_iLine = (yyvsp[-3].m_iLine);
                     }
+#line 1247 "parser.cpp"
     break;
 
-  case 9:
-/* Line 1792 of yacc.c  */
-#line 100 "parser.y"
-    {
-                FieldStorage fs(AP_VIEW, VD_NORTH, (yyvsp[(1) - (1)].m_iLine));
+  case 11: /* Direction: NORTHKW  */
+#line 115 "parser.y"
+            {
+                FieldStorage fs(AP_VIEW, VD_NORTH, (yyvsp[0].m_iLine));
                 (yyval.m_oField) = fs;
             }
+#line 1256 "parser.cpp"
     break;
 
-  case 10:
-/* Line 1792 of yacc.c  */
-#line 105 "parser.y"
-    {
-                FieldStorage fs(AP_VIEW, VD_EAST, (yyvsp[(1) - (1)].m_iLine));
+  case 12: /* Direction: EASTKW  */
+#line 120 "parser.y"
+            {
+                FieldStorage fs(AP_VIEW, VD_EAST, (yyvsp[0].m_iLine));
                 (yyval.m_oField) = fs;
             }
+#line 1265 "parser.cpp"
     break;
 
-  case 11:
-/* Line 1792 of yacc.c  */
-#line 110 "parser.y"
-    {
-                FieldStorage fs(AP_VIEW, VD_SOUTH, (yyvsp[(1) - (1)].m_iLine));
+  case 13: /* Direction: SOUTHKW  */
+#line 125 "parser.y"
+            {
+                FieldStorage fs(AP_VIEW, VD_SOUTH, (yyvsp[0].m_iLine));
                 (yyval.m_oField) = fs;
             }
+#line 1274 "parser.cpp"
     break;
 
-  case 12:
-/* Line 1792 of yacc.c  */
-#line 115 "parser.y"
-    {
-                FieldStorage fs(AP_VIEW, VD_WEST, (yyvsp[(1) - (1)].m_iLine));
+  case 14: /* Direction: WESTKW  */
+#line 130 "parser.y"
+            {
+                FieldStorage fs(AP_VIEW, VD_WEST, (yyvsp[0].m_iLine));
                 (yyval.m_oField) = fs;
             }
+#line 1283 "parser.cpp"
     break;
 
-  case 13:
-/* Line 1792 of yacc.c  */
-#line 122 "parser.y"
-    {
+  case 15: /* AnimationFrames: AnimationFrame  */
+#line 137 "parser.y"
+                  {
                       std::vector<AnimationFrame> elements;
                       (yyval.m_vFrames) = elements;
-                      (yyval.m_vFrames).push_back((yyvsp[(1) - (1)].m_oFrame));
+                      (yyval.m_vFrames).push_back((yyvsp[0].m_oFrame));
                   }
+#line 1293 "parser.cpp"
     break;
 
-  case 14:
-/* Line 1792 of yacc.c  */
-#line 128 "parser.y"
-    {
-                      (yyval.m_vFrames) = (yyvsp[(1) - (2)].m_vFrames);
-                      (yyval.m_vFrames).push_back((yyvsp[(2) - (2)].m_oFrame));
+  case 16: /* AnimationFrames: AnimationFrames AnimationFrame  */
+#line 143 "parser.y"
+                  {
+                      (yyval.m_vFrames) = (yyvsp[-1].m_vFrames);
+                      (yyval.m_vFrames).push_back((yyvsp[0].m_oFrame));
                   }
+#line 1302 "parser.cpp"
     break;
 
-  case 15:
-/* Line 1792 of yacc.c  */
-#line 135 "parser.y"
-    {
-                     AnimationFrame af((yyvsp[(1) - (5)].m_iLine));
-                     af.SetProperty((yyvsp[(3) - (5)].m_oField));
-                     af.SetElements((yyvsp[(4) - (5)].m_vElements));
+  case 17: /* AnimationFrame: FRAMEKW CURLY_OPEN FrameProperty FrameElements CURLY_CLOSE  */
+#line 150 "parser.y"
+                 {
+                     AnimationFrame af((yyvsp[-4].m_iLine));
+                     af.SetProperty((yyvsp[-2].m_oField));
+                     af.SetElements((yyvsp[-1].m_vElements));
                      (yyval.m_oFrame) = af;
                  }
+#line 1313 "parser.cpp"
     break;
 
-  case 16:
-/* Line 1792 of yacc.c  */
-#line 144 "parser.y"
-    {
+  case 18: /* FrameProperty: %empty  */
+#line 159 "parser.y"
+                {
                     FieldStorage fs;
                     (yyval.m_oField) = fs;
                 }
+#line 1322 "parser.cpp"
     break;
 
-  case 17:
-/* Line 1792 of yacc.c  */
-#line 149 "parser.y"
-    {
-                    FieldStorage fs(AF_SOUND, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 19: /* FrameProperty: SOUNDKW EQUAL NUMBER SEMICOL  */
+#line 164 "parser.y"
+                {
+                    FieldStorage fs(AF_SOUND, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                     (yyval.m_oField) = fs;
                 }
+#line 1331 "parser.cpp"
     break;
 
-  case 18:
-/* Line 1792 of yacc.c  */
-#line 156 "parser.y"
-    {
+  case 20: /* FrameElements: FrameElement  */
+#line 171 "parser.y"
+                {
                     std::vector<FrameElement> elements;
                     (yyval.m_vElements) = elements;
-                    (yyval.m_vElements).push_back((yyvsp[(1) - (1)].m_oElement));
+                    (yyval.m_vElements).push_back((yyvsp[0].m_oElement));
                 }
+#line 1341 "parser.cpp"
     break;
 
-  case 19:
-/* Line 1792 of yacc.c  */
-#line 162 "parser.y"
-    {
-                    (yyval.m_vElements) = (yyvsp[(1) - (2)].m_vElements);
-                    (yyval.m_vElements).push_back((yyvsp[(2) - (2)].m_oElement));
+  case 21: /* FrameElements: FrameElements FrameElement  */
+#line 177 "parser.y"
+                {
+                    (yyval.m_vElements) = (yyvsp[-1].m_vElements);
+                    (yyval.m_vElements).push_back((yyvsp[0].m_oElement));
                 }
+#line 1350 "parser.cpp"
     break;
 
-  case 20:
-/* Line 1792 of yacc.c  */
-#line 169 "parser.y"
-    {
-                   FrameElement fe((yyvsp[(1) - (4)].m_iLine));
-                   fe.SetProperties((yyvsp[(3) - (4)].m_vFields));
+  case 22: /* FrameElement: ELEMENTKW CURLY_OPEN ElementFields CURLY_CLOSE  */
+#line 184 "parser.y"
+               {
+                   FrameElement fe((yyvsp[-3].m_iLine));
+                   fe.SetProperties((yyvsp[-1].m_vFields));
                    (yyval.m_oElement) = fe;
                }
+#line 1360 "parser.cpp"
     break;
 
-  case 21:
-/* Line 1792 of yacc.c  */
-#line 177 "parser.y"
-    {
+  case 23: /* ElementFields: ElementField  */
+#line 192 "parser.y"
+                {
                     std::vector<FieldStorage> fss;
                     (yyval.m_vFields) = fss;
-                    (yyval.m_vFields).push_back((yyvsp[(1) - (1)].m_oField));
+                    (yyval.m_vFields).push_back((yyvsp[0].m_oField));
                 }
+#line 1370 "parser.cpp"
     break;
 
-  case 22:
-/* Line 1792 of yacc.c  */
-#line 183 "parser.y"
-    {
-                    (yyval.m_vFields) = (yyvsp[(1) - (2)].m_vFields);
-                    (yyval.m_vFields).push_back((yyvsp[(2) - (2)].m_oField));
+  case 24: /* ElementFields: ElementFields ElementField  */
+#line 198 "parser.y"
+                {
+                    (yyval.m_vFields) = (yyvsp[-1].m_vFields);
+                    (yyval.m_vFields).push_back((yyvsp[0].m_oField));
                 }
+#line 1379 "parser.cpp"
     break;
 
-  case 23:
-/* Line 1792 of yacc.c  */
-#line 190 "parser.y"
-    {
-                   FieldStorage fs(FE_TOP, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 25: /* ElementField: TOPKW EQUAL NUMBER SEMICOL  */
+#line 205 "parser.y"
+               {
+                   FieldStorage fs(FE_TOP, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1388 "parser.cpp"
     break;
 
-  case 24:
-/* Line 1792 of yacc.c  */
-#line 195 "parser.y"
-    {
-                   FieldStorage fs(FE_LEFT, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 26: /* ElementField: LEFTKW EQUAL NUMBER SEMICOL  */
+#line 210 "parser.y"
+               {
+                   FieldStorage fs(FE_LEFT, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1397 "parser.cpp"
     break;
 
-  case 25:
-/* Line 1792 of yacc.c  */
-#line 200 "parser.y"
-    {
-                   FieldStorage fs(FE_WIDTH, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 27: /* ElementField: WIDTHKW EQUAL NUMBER SEMICOL  */
+#line 215 "parser.y"
+               {
+                   FieldStorage fs(FE_WIDTH, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1406 "parser.cpp"
     break;
 
-  case 26:
-/* Line 1792 of yacc.c  */
-#line 205 "parser.y"
-    {
-                   FieldStorage fs(FE_HEIGHT, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 28: /* ElementField: HEIGHTKW EQUAL NUMBER SEMICOL  */
+#line 220 "parser.y"
+               {
+                   FieldStorage fs(FE_HEIGHT, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1415 "parser.cpp"
     break;
 
-  case 27:
-/* Line 1792 of yacc.c  */
-#line 210 "parser.y"
-    {
-                   FieldStorage fs(FE_XOFFSET, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 29: /* ElementField: X_OFFSETKW EQUAL NUMBER SEMICOL  */
+#line 225 "parser.y"
+               {
+                   FieldStorage fs(FE_XOFFSET, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1424 "parser.cpp"
     break;
 
-  case 28:
-/* Line 1792 of yacc.c  */
-#line 215 "parser.y"
-    {
-                   FieldStorage fs(FE_YOFFSET, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 30: /* ElementField: Y_OFFSETKW EQUAL NUMBER SEMICOL  */
+#line 230 "parser.y"
+               {
+                   FieldStorage fs(FE_YOFFSET, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1433 "parser.cpp"
     break;
 
-  case 29:
-/* Line 1792 of yacc.c  */
-#line 220 "parser.y"
-    {
-                   FieldStorage fs(FE_IMAGE, (yyvsp[(3) - (4)].m_sText), (yyvsp[(1) - (4)].m_iLine));
+  case 31: /* ElementField: BASE_IMGKW EQUAL STRING SEMICOL  */
+#line 235 "parser.y"
+               {
+                   FieldStorage fs(FE_IMAGE, (yyvsp[-1].m_sText), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1442 "parser.cpp"
     break;
 
-  case 30:
-/* Line 1792 of yacc.c  */
-#line 225 "parser.y"
-    {
-                   FieldStorage fs(FE_RECOLOUR, (yyvsp[(3) - (4)].m_sText), (yyvsp[(1) - (4)].m_iLine));
+  case 32: /* ElementField: RECOLOURKW EQUAL STRING SEMICOL  */
+#line 240 "parser.y"
+               {
+                   FieldStorage fs(FE_RECOLOUR, (yyvsp[-1].m_sText), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1451 "parser.cpp"
     break;
 
-  case 31:
-/* Line 1792 of yacc.c  */
-#line 230 "parser.y"
-    {
-                   FieldStorage fs(FE_RECOLLAYER, (yyvsp[(2) - (5)].m_iNumber), (yyvsp[(4) - (5)].m_iNumber), (yyvsp[(1) - (5)].m_iLine));
+  case 33: /* ElementField: LAYERKW NUMBER EQUAL NUMBER SEMICOL  */
+#line 245 "parser.y"
+               {
+                   FieldStorage fs(FE_RECOLLAYER, (yyvsp[-3].m_iNumber), (yyvsp[-1].m_iNumber), (yyvsp[-4].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1460 "parser.cpp"
     break;
 
-  case 32:
-/* Line 1792 of yacc.c  */
-#line 235 "parser.y"
-    {
-                   FieldStorage fs(FE_DISPLAY, (yyvsp[(2) - (5)].m_iNumber), (yyvsp[(4) - (5)].m_iNumber), (yyvsp[(1) - (5)].m_iLine));
+  case 34: /* ElementField: DISPLAYKW NUMBER EQUAL NUMBER SEMICOL  */
+#line 250 "parser.y"
+               {
+                   FieldStorage fs(FE_DISPLAY, (yyvsp[-3].m_iNumber), (yyvsp[-1].m_iNumber), (yyvsp[-4].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1469 "parser.cpp"
     break;
 
-  case 33:
-/* Line 1792 of yacc.c  */
-#line 240 "parser.y"
-    {
-                   FieldStorage fs(FE_ALPHA, (yyvsp[(3) - (4)].m_iNumber), (yyvsp[(1) - (4)].m_iLine));
+  case 35: /* ElementField: ALPHAKW EQUAL NUMBER SEMICOL  */
+#line 255 "parser.y"
+               {
+                   FieldStorage fs(FE_ALPHA, (yyvsp[-1].m_iNumber), (yyvsp[-3].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1478 "parser.cpp"
     break;
 
-  case 34:
-/* Line 1792 of yacc.c  */
-#line 245 "parser.y"
-    {
-                   FieldStorage fs(FE_HORFLIP, 1, (yyvsp[(1) - (1)].m_iLine));
+  case 36: /* ElementField: HOR_FLIPKW  */
+#line 260 "parser.y"
+               {
+                   FieldStorage fs(FE_HORFLIP, 1, (yyvsp[0].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1487 "parser.cpp"
     break;
 
-  case 35:
-/* Line 1792 of yacc.c  */
-#line 250 "parser.y"
-    {
-                   FieldStorage fs(FE_VERTFLIP, 1, (yyvsp[(1) - (1)].m_iLine));
+  case 37: /* ElementField: VERT_FLIPKW  */
+#line 265 "parser.y"
+               {
+                   FieldStorage fs(FE_VERTFLIP, 1, (yyvsp[0].m_iLine));
                    (yyval.m_oField) = fs;
                }
+#line 1496 "parser.cpp"
     break;
 
 
-/* Line 1792 of yacc.c  */
-#line 1746 "parser.cpp"
+#line 1500 "parser.cpp"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -1756,96 +1511,58 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
-	 error, discard it.  */
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
     }
 
   /* Else will try to reuse lookahead token after shifting the error
@@ -1857,14 +1574,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -1877,29 +1593,30 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1911,7 +1628,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -1922,26 +1639,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -1950,31 +1671,25 @@ yyreturn:
       yydestruct ("Cleanup: discarding lookahead",
                   yytoken, &yylval);
     }
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
 
+  return yyresult;
+}
 
-/* Line 2055 of yacc.c  */
-#line 256 "parser.y"
+#line 271 "parser.y"
 
 
 void yyerror(const char *msg)
@@ -26,6 +26,7 @@ SOFTWARE.
 #include "scanparse.h"
 
 std::vector<Animation> g_vAnimations;
+std::vector<NumberedSprite> g_vSprites;
 %}
 
 
@@ -34,12 +35,13 @@ std::vector<Animation> g_vAnimations;
 %token<m_iLine> ALPHAKW HOR_FLIPKW VERT_FLIPKW
 
 %token<m_iLine> X_OFFSETKW Y_OFFSETKW ANIMATIONKW FRAMEKW TILE_SIZEKW VIEWKW SOUNDKW
-%token<m_iLine> NORTHKW WESTKW SOUTHKW EASTKW ELEMENTKW DISPLAYKW
+%token<m_iLine> NORTHKW WESTKW SOUTHKW EASTKW ELEMENTKW DISPLAYKW SPRITEKW
 
 %token<m_iNumber> NUMBER
 %token<m_sText> STRING
 
 %type<m_oAnimation> Animation
+%type<m_oSprite> Sprite
 %type<m_oFrame> AnimationFrame
 %type<m_vFrames> AnimationFrames
 %type<m_oElement> FrameElement
@@ -55,11 +57,16 @@ std::vector<Animation> g_vAnimations;
 Program : /* empty */
           {
               g_vAnimations.clear();
+              g_vSprites.clear();
           }
         | Program Animation
           {
               g_vAnimations.push_back($2);
           }
+        | Program Sprite
+          {
+              g_vSprites.push_back($2);
+          }
         ;
 
 Animation : ANIMATIONKW STRING CURLY_OPEN AnimationProperties AnimationFrames CURLY_CLOSE
@@ -71,6 +78,14 @@ Animation : ANIMATIONKW STRING CURLY_OPEN AnimationProperties AnimationFrames CU
             }
           ;
 
+Sprite : SPRITEKW NUMBER CURLY_OPEN ElementFields CURLY_CLOSE
+         {
+             NumberedSprite ns($1, $2);
+             ns.SetProperties($4);
+             $$ = ns;
+         }
+       ;
+
 AnimationProperties : AnimationProperty
                       {
                           std::vector<FieldStorage> fss;
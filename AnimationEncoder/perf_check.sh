@@ -0,0 +1,213 @@
+#!/bin/sh
+# Copyright (c) 2013- Albert "Alberth" Hofkamp
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Performance regression check of the encoder.
+#
+# Usage: sh perf_check.sh [--update]
+#
+# Runs the encoder $RUNS times over each animation file of the corpus, and
+# compares the median wall time, the peak memory, the output size, the number
+# of sprites, and the checksum of the output with perf_baseline.json. With
+# --update, the measured values are written as the new baseline instead.
+
+RUNS=${RUNS:-5}
+UPDATE=0
+if [ "$1" = "--update" ]; then UPDATE=1; fi
+
+cd "$(dirname "$0")/.." || exit 1
+BASELINE=AnimationEncoder/perf_baseline.json
+ENCODER=AnimationEncoder/encoder
+if [ ! -x "$ENCODER" ]; then
+    echo "Encoder not found, run 'make' first" >&2
+    exit 1
+fi
+
+WORK=${TMPDIR:-/tmp}/perf_check.$$
+mkdir -p "$WORK" || exit 1
+trap 'rm -rf "$WORK"' 0
+
+# Generate the large animation file: 200 animations of 4 views with 8 frames
+# of 4 elements, each element a different part of one of the (RGBA) ground tiles 1 to 60.
+awk -v dir="$PWD/ground_tiles" 'BEGIN {
+    split("north east south west", views, " ");
+    for (a = 0; a < 200; a++) {
+        for (v = 1; v <= 4; v++) {
+            printf("animation \"large_%d\" {\n    view = %s;\n", a, views[v]);
+            for (f = 0; f < 8; f++) {
+                printf("    frame {\n");
+                for (e = 0; e < 4; e++) {
+                    tile = (a * 7 + v * 5 + f * 3 + e) % 60 + 1;
+                    printf("        element { base = \"%s/s%d.png\"; left = %d; top = %d; width = 32; height = 16; x_offset = %d; y_offset = %d; }\n",
+                           dir, tile, (f * 4 + e + v) % 32, (a + e) % 16, e * 32 - 64, -16);
+                }
+                printf("    }\n");
+            }
+            printf("}\n\n");
+        }
+    }
+}' > "$WORK/large.txt"
+
+# Name and animation file of each corpus entry.
+CORPUS="plant_anim:plant_anim.txt ground_tiles:ground_tiles.txt large:$WORK/large.txt"
+
+# Value of a field of a corpus entry (or of the baseline if no entry is given) in the baseline.
+baseline_value() {
+    if [ -n "$1" ]; then
+        sed -n "s/.*\"name\": \"$1\".*\"$2\": \"\{0,1\}\([0-9.]*\).*/\1/p" "$BASELINE"
+    else
+        sed -n "s/^ *\"$2\": \([0-9.]*\).*/\1/p" "$BASELINE"
+    fi
+}
+
+# Value of a line of the statistics printed by the encoder.
+stats_value() {
+    sed -n "s/^$1: *\([0-9.]*\).*/\1/p" "$WORK/stats.txt"
+}
+
+# Whether $1 is bigger than $2 with a relative tolerance $3 and an absolute slack $4.
+exceeds() {
+    awk -v a="$1" -v b="$2" -v t="$3" -v s="$4" 'BEGIN { exit !(a > b * (1 + t) + s) }'
+}
+
+TIME_TOLERANCE=0.30
+TIME_SLACK_MS=20
+MEMORY_TOLERANCE=0.10
+SIZE_TOLERANCE=0.02
+if [ $UPDATE -eq 0 ]; then
+    if [ ! -f "$BASELINE" ]; then
+        echo "Baseline $BASELINE not found, create it with 'make perf-baseline'" >&2
+        exit 1
+    fi
+    TIME_TOLERANCE=$(baseline_value "" time_tolerance)
+    TIME_SLACK_MS=$(baseline_value "" time_slack_ms)
+    MEMORY_TOLERANCE=$(baseline_value "" memory_tolerance)
+    SIZE_TOLERANCE=$(baseline_value "" size_tolerance)
+fi
+
+FAILED=0
+ENTRIES=""
+printf '%-14s %8s %12s %12s %10s %8s\n' "corpus" "version" "median ms" "peak KiB" "size" "sprites"
+for ITEM in $CORPUS; do
+    NAME=${ITEM%%:*}
+    SPEC=${ITEM#*:}
+
+    # Skip an animation file of which the images are not available.
+    IMAGE=$(sed -n 's/.*base *= *"\([^"]*\)".*/\1/p' "$SPEC" | head -n 1)
+    if [ -n "$IMAGE" ] && [ ! -f "$IMAGE" ]; then
+        echo "$NAME: skipped, image \"$IMAGE\" not found"
+        continue
+    fi
+
+    : > "$WORK/times.txt"
+    PEAK=0
+    SUM=""
+    RUN=0
+    while [ $RUN -lt "$RUNS" ]; do
+        if ! "$ENCODER" --stats "$SPEC" "$WORK/out.bin" > "$WORK/stats.txt"; then
+            echo "$NAME: encoder failed" >&2
+            exit 1
+        fi
+        stats_value "Run time" >> "$WORK/times.txt"
+        MEMORY=$(stats_value "Peak memory")
+        if [ "$MEMORY" -gt "$PEAK" ]; then PEAK=$MEMORY; fi
+
+        RUN_SUM=$(cksum < "$WORK/out.bin" | awk '{ print $1 }')
+        if [ -n "$SUM" ] && [ "$SUM" != "$RUN_SUM" ]; then
+            echo "$NAME: FAIL, output differs between runs"
+            FAILED=1
+        fi
+        SUM=$RUN_SUM
+        RUN=$((RUN + 1))
+    done
+    TIME=$(sort -n "$WORK/times.txt" | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }')
+    VERSION=$(stats_value "Format version")
+    SIZE=$(stats_value "Output size")
+    SPRITES=$(stats_value "Sprites")
+    printf '%-14s %8s %12s %12s %10s %8s\n' "$NAME" "$VERSION" "$TIME" "$PEAK" "$SIZE" "$SPRITES"
+
+    ENTRY=$(printf '        {"name": "%s", "version": %s, "time_ms": %s, "peak_kib": %s, "size": %s, "sprites": %s, "cksum": "%s"}' \
+            "$NAME" "$VERSION" "$TIME" "$PEAK" "$SIZE" "$SPRITES" "$SUM")
+    if [ -z "$ENTRIES" ]; then
+        ENTRIES=$ENTRY
+    else
+        ENTRIES=$(printf '%s,\n%s' "$ENTRIES" "$ENTRY")
+    fi
+    if [ $UPDATE -eq 1 ]; then continue; fi
+
+    BASE_VERSION=$(baseline_value "$NAME" version)
+    if [ -z "$BASE_VERSION" ]; then
+        echo "$NAME: no baseline, not compared"
+        continue
+    fi
+    BASE_TIME=$(baseline_value "$NAME" time_ms)
+    BASE_PEAK=$(baseline_value "$NAME" peak_kib)
+    BASE_SIZE=$(baseline_value "$NAME" size)
+    BASE_SPRITES=$(baseline_value "$NAME" sprites)
+    BASE_SUM=$(baseline_value "$NAME" cksum)
+
+    if exceeds "$TIME" "$BASE_TIME" "$TIME_TOLERANCE" "$TIME_SLACK_MS"; then
+        echo "$NAME: FAIL, median time $TIME ms, baseline $BASE_TIME ms"
+        FAILED=1
+    fi
+    if exceeds "$PEAK" "$BASE_PEAK" "$MEMORY_TOLERANCE" 0; then
+        echo "$NAME: FAIL, peak memory $PEAK KiB, baseline $BASE_PEAK KiB"
+        FAILED=1
+    fi
+    if [ "$SPRITES" != "$BASE_SPRITES" ]; then
+        echo "$NAME: FAIL, $SPRITES sprites, baseline $BASE_SPRITES sprites"
+        FAILED=1
+    fi
+    if [ "$VERSION" = "$BASE_VERSION" ]; then
+        if [ "$SUM" != "$BASE_SUM" ]; then
+            echo "$NAME: FAIL, output changed without changing format version $VERSION"
+            FAILED=1
+        fi
+    else
+        echo "$NAME: format version changed from $BASE_VERSION to $VERSION, output not compared"
+        if exceeds "$SIZE" "$BASE_SIZE" "$SIZE_TOLERANCE" 0; then
+            echo "$NAME: FAIL, output size $SIZE bytes, baseline $BASE_SIZE bytes"
+            FAILED=1
+        fi
+    fi
+done
+
+if [ $UPDATE -eq 1 ]; then
+    {
+        echo "{"
+        echo "    \"runs\": $RUNS,"
+        echo "    \"time_tolerance\": $TIME_TOLERANCE,"
+        echo "    \"time_slack_ms\": $TIME_SLACK_MS,"
+        echo "    \"memory_tolerance\": $MEMORY_TOLERANCE,"
+        echo "    \"size_tolerance\": $SIZE_TOLERANCE,"
+        echo "    \"corpus\": ["
+        echo "$ENTRIES"
+        echo "    ]"
+        echo "}"
+    } > "$BASELINE"
+    echo "Baseline written to $BASELINE"
+    exit 0
+fi
+
+if [ $FAILED -ne 0 ]; then
+    echo "-- Performance regression"
+    exit 1
+fi
+echo "Success"
@@ -0,0 +1,194 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file prefetch.cpp Reading image files ahead of the encoder.
+/*!
+    The encoder reads the image files one at a time, just before encoding their sprites.
+    With files that are not in the file system cache (or on a network drive), it spends
+    much of its time waiting for the disk. The prefetcher reads the files in the order
+    of the encoder, in a few threads, a number of files ahead of the encoder. The read
+    data is dropped, the encoder gets it from the file system cache when it needs the file.
+*/
+
+#include "prefetch.h"
+#include "trace.h"
+
+#ifndef _WIN32
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+static const int PREFETCH_THREADS = 2;        ///< Number of threads reading files.
+static const int PREFETCH_BUFFER_SIZE = 65536; ///< Size of the buffer of a thread.
+
+static pthread_mutex_t g_oMutex = PTHREAD_MUTEX_INITIALIZER; ///< Protection of the prefetch data.
+static pthread_cond_t g_oChanged = PTHREAD_COND_INITIALIZER; ///< Signal of a change in the prefetch data.
+static std::vector<std::string> g_vFiles; ///< Files in the order of use by the encoder.
+static size_t g_iNext;   ///< Index of the next file to read.
+static size_t g_iUsed;   ///< Index of the file used last by the encoder.
+static size_t g_iWindow; ///< Number of files to read ahead of the encoder.
+static bool g_bStop;     ///< Whether the threads should stop.
+static pthread_t g_aThreads[PREFETCH_THREADS]; ///< Threads reading the files.
+static int g_iThreads = 0; ///< Number of running threads.
+
+//! Read a file into the file system cache.
+/*!
+    @param sFilename Name of the file to read.
+    @param pBuffer Buffer for the read data.
+ */
+static void ReadFile(const std::string &sFilename, char *pBuffer)
+{
+    TraceSpan oSpan("prefetch", sFilename);
+    int iFd = open(sFilename.c_str(), O_RDONLY);
+    if (iFd < 0)
+        return; // The encoder reports missing files.
+
+    long long iTotal = 0;
+    ssize_t iRead;
+    while ((iRead = read(iFd, pBuffer, PREFETCH_BUFFER_SIZE)) > 0)
+        iTotal += iRead;
+    close(iFd);
+    oSpan.SetBytes(iTotal);
+}
+
+//! Thread reading the files ahead of the encoder.
+/*!
+    The argument is unused.
+    @return Unused.
+ */
+static void *PrefetchThread(void *)
+{
+    char *pBuffer = new char[PREFETCH_BUFFER_SIZE];
+    SetTraceThreadName("prefetch");
+
+    pthread_mutex_lock(&g_oMutex);
+    for (;;)
+    {
+        while (!g_bStop && g_iNext < g_vFiles.size() && g_iNext >= g_iUsed + g_iWindow)
+            pthread_cond_wait(&g_oChanged, &g_oMutex);
+        if (g_bStop || g_iNext >= g_vFiles.size())
+            break;
+
+        std::string sFilename = g_vFiles[g_iNext];
+        g_iNext++;
+        pthread_mutex_unlock(&g_oMutex);
+        ReadFile(sFilename, pBuffer);
+        pthread_mutex_lock(&g_oMutex);
+    }
+    pthread_mutex_unlock(&g_oMutex);
+
+    delete[] pBuffer;
+    return NULL;
+}
+
+//! Start reading files ahead of the encoder.
+/*!
+    @param vFiles Image files in the order of use by the encoder.
+    @param iWindow Number of files to read ahead of the encoder.
+ */
+void StartPrefetch(const std::vector<std::string> &vFiles, int iWindow)
+{
+    g_vFiles.clear();
+    for (size_t i = 0; i < vFiles.size(); i++)
+    {
+        if (g_vFiles.empty() || g_vFiles.back() != vFiles[i])
+            g_vFiles.push_back(vFiles[i]);
+    }
+    g_iNext = 0;
+    g_iUsed = 0;
+    g_iWindow = iWindow;
+    g_bStop = false;
+
+    // Also stop the threads when the encoder exits on an error.
+    static bool bRegistered = false;
+    if (!bRegistered)
+    {
+        atexit(StopPrefetch);
+        bRegistered = true;
+    }
+
+    for (g_iThreads = 0; g_iThreads < PREFETCH_THREADS; g_iThreads++)
+    {
+        if (pthread_create(&g_aThreads[g_iThreads], NULL, PrefetchThread, NULL) != 0)
+            break; // Continue with fewer threads.
+    }
+}
+
+//! Notify the prefetcher that the encoder uses a file, so it may read further ahead.
+/*!
+    @param sFilename Name of the used file.
+ */
+void PrefetchUsed(const std::string &sFilename)
+{
+    if (g_iThreads == 0)
+        return;
+
+    pthread_mutex_lock(&g_oMutex);
+    size_t iLast = g_iUsed + 2 * g_iWindow + 1;
+    if (iLast > g_vFiles.size()) iLast = g_vFiles.size();
+    for (size_t i = g_iUsed; i < iLast; i++)
+    {
+        if (g_vFiles[i] == sFilename)
+        {
+            g_iUsed = i;
+            pthread_cond_broadcast(&g_oChanged);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_oMutex);
+}
+
+//! Stop reading files ahead of the encoder.
+void StopPrefetch()
+{
+    if (g_iThreads == 0)
+        return;
+
+    pthread_mutex_lock(&g_oMutex);
+    g_bStop = true;
+    pthread_cond_broadcast(&g_oChanged);
+    pthread_mutex_unlock(&g_oMutex);
+
+    for (int i = 0; i < g_iThreads; i++)
+        pthread_join(g_aThreads[i], NULL);
+    g_iThreads = 0;
+}
+
+#else
+
+void StartPrefetch(const std::vector<std::string> &, int)
+{
+}
+
+void PrefetchUsed(const std::string &)
+{
+}
+
+void StopPrefetch()
+{
+}
+
+#endif
+
+// vim: et sw=4 ts=4 sts=4
@@ -0,0 +1,83 @@
+#!/bin/sh
+# Copyright (c) 2013- Albert "Alberth" Hofkamp
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Regression check of the encoder.
+#
+# Usage: sh regression_check.sh
+#
+# Encodes each animation file in the regression directory with the options
+# that once broke it, with --verify to compare the decoded sprites with the
+# images. Broken input files are checked to be rejected with an error.
+
+cd "$(dirname "$0")/.." || exit 1
+ENCODER=AnimationEncoder/encoder
+if [ ! -x "$ENCODER" ]; then
+    echo "Encoder not found, run 'make' first" >&2
+    exit 1
+fi
+
+WORK=${TMPDIR:-/tmp}/regression_check.$$
+mkdir -p "$WORK" || exit 1
+trap 'rm -rf "$WORK"' 0
+
+FAILED=0
+
+# Run the encoder on an animation file.
+# $1 Animation file in the regression directory.
+# $2... Options of the encoder.
+check() {
+    SPEC=$1
+    shift
+    if "$ENCODER" --verify "$@" "regression/$SPEC" "$WORK/out.bin" > "$WORK/log.txt" 2>&1; then
+        echo "$SPEC $*: ok"
+    else
+        echo "$SPEC $*: FAIL"
+        cat "$WORK/log.txt"
+        FAILED=1
+    fi
+}
+
+# Run the encoder on an animation file that must be rejected with an error.
+# $1 Animation file in the regression directory.
+# $2 Expected error message.
+check_error() {
+    if "$ENCODER" "regression/$1" "$WORK/out.bin" > "$WORK/log.txt" 2>&1; then
+        echo "$1: FAIL, no error"
+        FAILED=1
+    elif grep -q "$2" "$WORK/log.txt"; then
+        echo "$1: ok"
+    else
+        echo "$1: FAIL, other error"
+        cat "$WORK/log.txt"
+        FAILED=1
+    fi
+}
+
+check atlas_groups.txt --atlas "$WORK/atlas"
+check fill_recolour.txt --optimal --fill-runs --long-runs
+check atlas_groups.txt --no-mmap
+check_error truncated_qoi.txt "ends unexpectedly"
+
+if [ $FAILED -ne 0 ]; then
+    echo "-- Regression"
+    exit 1
+fi
+echo "Success"
@@ -0,0 +1,243 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file report.cpp Report of the size of each animation group in the output.
+/*!
+    A sprite used by several animation groups has its bytes divided evenly over those
+    groups, so the attributed bytes of all groups add up to the size of the sprites.
+    The decoded size counts each sprite that a group uses in full, as the game needs
+    all of them in memory to display the animations of the group.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <algorithm>
+#include "ast.h"
+#include "storage.h"
+#include "decoder.h"
+#include "report.h"
+
+//! Names of the run types in the report, by #RunType.
+static const char *g_aRunTypeNames[RT_COUNT] = {"opaque", "partial", "rgba", "fill", "transparent", "recolour"};
+
+ReportGroup::ReportGroup()
+{
+    m_sName = "";
+    m_iTileSize = 0;
+    m_iViews = 0;
+    m_iFrames = 0;
+}
+
+//! Sizes of a sprite, for the report.
+struct SpriteSizes
+{
+    SpriteLayout oLayout; ///< Sizes of the parts of the sprite block.
+    int iBlockSize;       ///< Size of the sprite block in bytes.
+    int iDecodedSize;     ///< Size of the decoded sprite (RGBA) in bytes.
+    int iGroups;          ///< Number of groups using the sprite.
+};
+
+//! Line of the report, the sizes of an animation group.
+struct GroupSizes
+{
+    const ReportGroup *pGroup;   ///< Group of the line.
+    int iSprites;                ///< Number of different sprites used by the group.
+    int iUniqueSprites;          ///< Number of sprites used by this group only.
+    double fBytes;               ///< Attributed bytes of the sprite blocks.
+    double aRunBytes[RT_COUNT];  ///< Attributed bytes of each run type.
+    double fBlockBytes;          ///< Attributed bytes of the sprite block headers, row tables, and palettes.
+    long long iDecodedSize;      ///< Decoded size of the used sprites in bytes.
+};
+
+//! Order of the lines in the report, biggest groups first.
+/*!
+    @param gs1 First line to compare.
+    @param gs2 Second line to compare.
+    @return Whether the first line should be before the second line.
+ */
+static bool ReportBefore(const GroupSizes &gs1, const GroupSizes &gs2)
+{
+    if (gs1.fBytes != gs2.fBytes) return gs1.fBytes > gs2.fBytes;
+    return gs1.pGroup->m_sName < gs2.pGroup->m_sName;
+}
+
+//! Compute the lines of the report.
+/*!
+    @param vGroups Groups with their used sprites.
+    @param vSprites Encoded sprite blocks, by sprite number.
+    @return Lines of the report, biggest groups first.
+ */
+static std::vector<GroupSizes> ComputeGroupSizes(const std::vector<ReportGroup> &vGroups,
+                                                 const std::vector<const EncodedSprite *> &vSprites)
+{
+    std::vector<SpriteSizes> vSizes(vSprites.size());
+    for (size_t i = 0; i < vSprites.size(); i++)
+    {
+        SpriteSizes &oSizes = vSizes[i];
+        oSizes.iBlockSize = vSprites[i]->m_iSize;
+        oSizes.iDecodedSize = 0;
+        oSizes.iGroups = 0;
+        DecodedSprite *pDecoded = DecodeSprite(vSprites[i]->m_pData, vSprites[i]->m_iSize, 0, -1, &oSizes.oLayout);
+        if (pDecoded != NULL)
+        {
+            oSizes.iDecodedSize = pDecoded->iWidth * pDecoded->iHeight * 4;
+            delete pDecoded;
+        }
+    }
+
+    std::vector<std::set<int> > vUsed(vGroups.size());
+    for (size_t g = 0; g < vGroups.size(); g++)
+    {
+        for (size_t i = 0; i < vGroups[g].m_vSprites.size(); i++)
+        {
+            int iSprite = vGroups[g].m_vSprites[i];
+            if (iSprite >= 0 && iSprite < (int)vSizes.size() && vUsed[g].insert(iSprite).second)
+                vSizes[iSprite].iGroups++;
+        }
+    }
+
+    std::vector<GroupSizes> vLines(vGroups.size());
+    for (size_t g = 0; g < vGroups.size(); g++)
+    {
+        GroupSizes &oLine = vLines[g];
+        oLine.pGroup = &vGroups[g];
+        oLine.iSprites = vUsed[g].size();
+        oLine.iUniqueSprites = 0;
+        oLine.fBytes = 0.0;
+        for (int t = 0; t < RT_COUNT; t++)
+            oLine.aRunBytes[t] = 0.0;
+        oLine.fBlockBytes = 0.0;
+        oLine.iDecodedSize = 0;
+
+        for (std::set<int>::const_iterator iter = vUsed[g].begin(); iter != vUsed[g].end(); iter++)
+        {
+            const SpriteSizes &oSizes = vSizes[*iter];
+            if (oSizes.iGroups == 1)
+                oLine.iUniqueSprites++;
+
+            double fShare = 1.0 / oSizes.iGroups;
+            oLine.fBytes += oSizes.iBlockSize * fShare;
+            for (int t = 0; t < RT_COUNT; t++)
+                oLine.aRunBytes[t] += (oSizes.oLayout.m_aHeaderBytes[t] + oSizes.oLayout.m_aPayloadBytes[t]) * fShare;
+            oLine.fBlockBytes += oSizes.oLayout.m_iBlockBytes * fShare;
+            oLine.iDecodedSize += oSizes.iDecodedSize;
+        }
+    }
+    std::sort(vLines.begin(), vLines.end(), ReportBefore);
+    return vLines;
+}
+
+//! Write a text as quoted string, doubling quotes in CSV, or escaping them in JSON.
+/*!
+    @param pFile File to write to.
+    @param sText Text to write.
+    @param bJson Whether to write a JSON string.
+ */
+static void WriteQuoted(FILE *pFile, const std::string &sText, bool bJson)
+{
+    fputc('"', pFile);
+    for (size_t i = 0; i < sText.size(); i++)
+    {
+        unsigned char c = sText[i];
+        if (c == '"')
+            fputs(bJson ? "\\\"" : "\"\"", pFile);
+        else if (bJson && c == '\\')
+            fputs("\\\\", pFile);
+        else if (bJson && c < 0x20)
+            fprintf(pFile, "\\u%04x", c);
+        else
+            fputc(c, pFile);
+    }
+    fputc('"', pFile);
+}
+
+//! Write the size report of the animation groups.
+/*!
+    The report is written as JSON if the filename ends with \c .json, else as CSV.
+    @param sFilename File to write the report to.
+    @param vGroups Groups with their used sprites.
+    @param vSprites Encoded sprite blocks, by sprite number.
+ */
+void WriteReport(const std::string &sFilename, const std::vector<ReportGroup> &vGroups,
+                 const std::vector<const EncodedSprite *> &vSprites)
+{
+    std::vector<GroupSizes> vLines = ComputeGroupSizes(vGroups, vSprites);
+    bool bJson = sFilename.size() >= 5 && sFilename.compare(sFilename.size() - 5, 5, ".json") == 0;
+
+    FILE *pFile = fopen(sFilename.c_str(), "w");
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Report file \"%s\" could not be opened for writing.\n", sFilename.c_str());
+        exit(1);
+    }
+
+    if (bJson)
+        fprintf(pFile, "{\"groups\": [\n");
+    else
+    {
+        fprintf(pFile, "name,tile_size,views,frames,elements,sprites,unique_sprites,shared_sprites,sprite_bytes");
+        for (int t = 0; t < RT_COUNT; t++)
+            fprintf(pFile, ",%s_bytes", g_aRunTypeNames[t]);
+        fprintf(pFile, ",block_bytes,decoded_bytes\n");
+    }
+
+    for (size_t i = 0; i < vLines.size(); i++)
+    {
+        const GroupSizes &oLine = vLines[i];
+        const ReportGroup &oGroup = *oLine.pGroup;
+        if (bJson)
+        {
+            fprintf(pFile, "%s  {\"name\": ", (i == 0) ? "" : ",\n");
+            WriteQuoted(pFile, oGroup.m_sName, true);
+            fprintf(pFile, ", \"tile_size\": %d, \"views\": %d, \"frames\": %d, \"elements\": %d",
+                    oGroup.m_iTileSize, oGroup.m_iViews, oGroup.m_iFrames, (int)oGroup.m_vSprites.size());
+            fprintf(pFile, ", \"sprites\": %d, \"unique_sprites\": %d, \"shared_sprites\": %d, \"sprite_bytes\": %.1f",
+                    oLine.iSprites, oLine.iUniqueSprites, oLine.iSprites - oLine.iUniqueSprites, oLine.fBytes);
+            fprintf(pFile, ", \"run_bytes\": {");
+            for (int t = 0; t < RT_COUNT; t++)
+                fprintf(pFile, "%s\"%s\": %.1f", (t == 0) ? "" : ", ", g_aRunTypeNames[t], oLine.aRunBytes[t]);
+            fprintf(pFile, "}, \"block_bytes\": %.1f, \"decoded_bytes\": %lld}", oLine.fBlockBytes, oLine.iDecodedSize);
+        }
+        else
+        {
+            WriteQuoted(pFile, oGroup.m_sName, false);
+            fprintf(pFile, ",%d,%d,%d,%d,%d,%d,%d,%.1f", oGroup.m_iTileSize, oGroup.m_iViews, oGroup.m_iFrames,
+                    (int)oGroup.m_vSprites.size(), oLine.iSprites, oLine.iUniqueSprites,
+                    oLine.iSprites - oLine.iUniqueSprites, oLine.fBytes);
+            for (int t = 0; t < RT_COUNT; t++)
+                fprintf(pFile, ",%.1f", oLine.aRunBytes[t]);
+            fprintf(pFile, ",%.1f,%lld\n", oLine.fBlockBytes, oLine.iDecodedSize);
+        }
+    }
+    if (bJson)
+        fprintf(pFile, "\n]}\n");
+
+    if (fclose(pFile) != 0)
+    {
+        fprintf(stderr, "Report file \"%s\" could not be written.\n", sFilename.c_str());
+        exit(1);
+    }
+}
+
+// vim: et sw=4 ts=4 sts=4
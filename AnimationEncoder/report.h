@@ -0,0 +1,52 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file report.h Report of the size of each animation group in the output.
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <string>
+#include <vector>
+
+class EncodedSprite;
+
+//! Use of the sprites by an animation group (or the sprite table), collected while encoding.
+class ReportGroup
+{
+public:
+    ReportGroup();
+
+    std::string m_sName;         ///< Name of the animation group.
+    int m_iTileSize;             ///< Tile size of the animation group (\c 0 for the sprite table).
+    int m_iViews;                ///< Number of views (animations) in the group.
+    int m_iFrames;               ///< Number of frames of all views together.
+    std::vector<int> m_vSprites; ///< Sprite of each element of the group.
+};
+
+void WriteReport(const std::string &sFilename, const std::vector<ReportGroup> &vGroups,
+                 const std::vector<const EncodedSprite *> &vSprites);
+
+#endif
+
+// vim: et sw=4 ts=4 sts=4
@@ -364,8 +364,8 @@ static void yy_fatal_error (yyconst char msg[]  );
 	*yy_cp = '\0'; \
 	(yy_c_buf_p) = yy_cp;
 
-#define YY_NUM_RULES 41
-#define YY_END_OF_BUFFER 42
+#define YY_NUM_RULES 42
+#define YY_END_OF_BUFFER 43
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -373,25 +373,26 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static yyconst flex_int16_t yy_accept[160] =
+static yyconst flex_int16_t yy_accept[165] =
     {   0,
-        0,    0,    0,    0,    0,    0,   42,   40,   38,   39,
-       37,   31,   40,   40,   28,   29,    4,    3,   40,   40,
-       40,   40,   40,   40,   40,   40,   40,   40,   40,   40,
-       40,   40,   40,    1,    2,   33,   41,   32,   36,   35,
-       30,   34,   29,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,    0,   43,   41,   39,   40,
+       38,   32,   41,   41,   29,   30,    4,    3,   41,   41,
+       41,   41,   41,   41,   41,   41,   41,   41,   41,   41,
+       41,   41,   41,    1,    2,   34,   42,   33,   37,   36,
+       31,   35,   30,    0,    0,    0,    0,    0,    0,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,    0,    0,    0,   30,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,    0,   31,    0,    0,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    6,    0,    0,    0,    0,    0,    0,    0,    0,
-        9,    0,   20,    0,    0,    0,    0,    0,    5,    0,
-
-        0,    0,    0,    0,    0,   24,   22,    0,    0,    0,
-       12,    0,    0,    0,   17,    0,    0,   11,   19,    0,
-       25,   21,    0,    0,    7,    0,    0,    0,    0,    0,
-        8,    0,    0,    0,    0,    0,    0,    0,    0,   18,
-        0,    0,    0,    0,    0,    0,    0,    0,   13,   10,
-        0,    0,   15,   16,   26,   27,   23,   14,    0
+        0,    0,    0,    6,    0,    0,    0,    0,    0,    0,
+        0,    0,    9,    0,   20,    0,    0,    0,    0,    0,
+
+        5,    0,    0,    0,    0,    0,    0,    0,   24,   22,
+        0,    0,    0,   12,    0,    0,    0,   17,    0,    0,
+       11,   19,    0,   25,   21,    0,    0,    0,    7,    0,
+        0,    0,    0,    0,    8,    0,    0,   27,    0,    0,
+        0,    0,    0,    0,   18,    0,    0,    0,    0,    0,
+        0,    0,    0,   13,   10,    0,    0,   15,   16,   26,
+       28,   23,   14,    0
     } ;
 
 static yyconst flex_int32_t yy_ec[256] =
@@ -434,102 +435,104 @@ static yyconst flex_int32_t yy_meta[38] =
         1,    1,    1,    1,    1,    1,    1
     } ;
 
-static yyconst flex_int16_t yy_base[162] =
+static yyconst flex_int16_t yy_base[167] =
     {   0,
-        0,    0,   35,   36,  167,  166,  168,  171,  171,  171,
-      171,  171,  158,  159,  171,   34,  171,  171,   22,  152,
-      143,   32,  136,   30,   35,  137,  144,  135,   28,   39,
-       40,  147,  146,  171,  171,  171,  171,  171,  171,  171,
-       42,  171,   50,  131,  135,  127,  128,  125,  135,  138,
-      129,  122,  114,  129,  119,  130,  114,  121,  116,  114,
-      123,  111,  122,  112,  111,   54,  115,  111,  116,  110,
-      102,  107,  106,  109,  115,  109,   96,   95,   98,   40,
-      105,  171,   92,   88,   90,   89,   99,   98,  102,  101,
-      171,  100,  171,   95,   94,   90,   91,   81,  171,   87,
-
-       84,   89,   84,   91,   90,  171,  171,   81,   82,   81,
-      171,   69,   63,   72,  171,   66,   72,  171,  171,   68,
-      171,  171,   64,   73,  171,   62,   61,   67,   75,   57,
-      171,   64,   54,   62,   60,   64,   63,   54,   57,  171,
-       51,   49,   40,   53,   44,   43,   47,   52,  171,  171,
-       51,   41,  171,  171,  171,  171,  171,  171,  171,   65,
-       64
+        0,    0,   35,   36,  172,  171,  173,  176,  176,  176,
+      176,  176,  163,  164,  176,   34,  176,  176,   22,  157,
+      148,   32,  141,   30,   35,  142,  149,   24,   32,   39,
+       41,  153,  152,  176,  176,  176,  176,  176,  176,  176,
+       55,  176,   57,  137,  141,  133,  134,  131,  141,  144,
+      135,  128,  120,  135,  125,  136,  120,  122,  126,  121,
+      119,  128,  116,  127,  117,  116,   59,  120,  116,  121,
+      115,  107,  112,  111,  114,  120,  114,  101,  100,  103,
+       45,  106,  109,  176,   96,   92,   94,   93,  103,  102,
+      106,  105,  176,  104,  176,   99,   98,   94,   95,   85,
+
+      176,   91,   88,   93,   88,   78,   94,   93,  176,  176,
+       84,   85,   84,  176,   72,   66,   75,  176,   69,   75,
+      176,  176,   71,  176,  176,   78,   66,   75,  176,   64,
+       63,   69,   77,   59,  176,   66,   56,  176,   64,   62,
+       66,   65,   56,   59,  176,   53,   51,   42,   55,   46,
+       44,   48,   53,  176,  176,   53,   35,  176,  176,  176,
+      176,  176,  176,  176,   58,   50
     } ;
 
-static yyconst flex_int16_t yy_def[162] =
+static yyconst flex_int16_t yy_def[167] =
     {   0,
-      159,    1,  160,  160,  161,  161,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,    0,  159,
-      159
+      164,    1,  165,  165,  166,  166,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,    0,  164,  164
     } ;
 
-static yyconst flex_int16_t yy_nxt[209] =
+static yyconst flex_int16_t yy_nxt[214] =
     {   0,
         8,    9,   10,   11,   12,   13,   14,   15,   16,   17,
        18,    8,   19,   20,    8,   21,   22,   23,    8,   24,
         8,   25,    8,   26,    8,    8,   27,   28,   29,    8,
        30,   31,   32,   33,    8,   34,   35,   37,   37,   38,
-       38,   43,   43,   44,   48,   45,   51,   53,   58,   66,
-       66,   54,   59,   49,   52,   60,   62,   43,   43,   61,
-       63,   66,   66,  102,   39,   36,  158,  157,  103,  156,
-      155,  154,  153,  152,  151,  150,  149,  148,  147,  146,
-      145,  144,  143,  142,  141,  140,  139,  138,  137,  136,
-      135,  134,  133,  132,  131,  130,  129,  128,  127,  126,
-
-      125,  124,  123,  122,  121,  120,  119,  118,  117,  116,
-      115,  114,  113,  112,  111,  110,  109,  108,  107,  106,
-      105,  104,  101,  100,   99,   98,   97,   96,   95,   94,
-       93,   92,   91,   90,   89,   88,   87,   86,   85,   84,
-       83,   82,   81,   80,   79,   78,   77,   76,   75,   74,
-       73,   72,   71,   70,   69,   68,   67,   65,   64,   57,
-       56,   55,   50,   47,   46,   42,   41,  159,   40,   40,
-        7,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-
-      159,  159,  159,  159,  159,  159,  159,  159
+       38,   43,   43,   44,   48,   45,   51,   53,   57,   58,
+       39,   54,   59,   49,   52,   61,   60,   63,   36,   62,
+      163,   64,   67,   67,   43,   43,   67,   67,  104,  162,
+      161,  160,  159,  105,  158,  157,  156,  155,  154,  153,
+      152,  151,  150,  149,  148,  147,  146,  145,  144,  143,
+      142,  141,  140,  139,  138,  137,  136,  135,  134,  133,
+
+      132,  131,  130,  129,  128,  127,  126,  125,  124,  123,
+      122,  121,  120,  119,  118,  117,  116,  115,  114,  113,
+      112,  111,  110,  109,  108,  107,  106,  103,  102,  101,
+      100,   99,   98,   97,   96,   95,   94,   93,   92,   91,
+       90,   89,   88,   87,   86,   85,   84,   83,   82,   81,
+       80,   79,   78,   77,   76,   75,   74,   73,   72,   71,
+       70,   69,   68,   66,   65,   56,   55,   50,   47,   46,
+       42,   41,  164,   40,   40,    7,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164
     } ;
 
-static yyconst flex_int16_t yy_chk[209] =
+static yyconst flex_int16_t yy_chk[214] =
     {   0,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    3,    4,    3,
-        4,   16,   16,   19,   22,   19,   24,   25,   29,   41,
-       41,   25,   29,   22,   24,   30,   31,   43,   43,   30,
-       31,   66,   66,   80,  161,  160,  152,  151,   80,  148,
-      147,  146,  145,  144,  143,  142,  141,  139,  138,  137,
-      136,  135,  134,  133,  132,  130,  129,  128,  127,  126,
-      124,  123,  120,  117,  116,  114,  113,  112,  110,  109,
-
-      108,  105,  104,  103,  102,  101,  100,   98,   97,   96,
-       95,   94,   92,   90,   89,   88,   87,   86,   85,   84,
-       83,   81,   79,   78,   77,   76,   75,   74,   73,   72,
-       71,   70,   69,   68,   67,   65,   64,   63,   62,   61,
-       60,   59,   58,   57,   56,   55,   54,   53,   52,   51,
-       50,   49,   48,   47,   46,   45,   44,   33,   32,   28,
-       27,   26,   23,   21,   20,   14,   13,    7,    6,    5,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-      159,  159,  159,  159,  159,  159,  159,  159,  159,  159,
-
-      159,  159,  159,  159,  159,  159,  159,  159
+        4,   16,   16,   19,   22,   19,   24,   25,   28,   28,
+      166,   25,   29,   22,   24,   30,   29,   31,  165,   30,
+      157,   31,   41,   41,   43,   43,   67,   67,   81,  156,
+      153,  152,  151,   81,  150,  149,  148,  147,  146,  144,
+      143,  142,  141,  140,  139,  137,  136,  134,  133,  132,
+      131,  130,  128,  127,  126,  123,  120,  119,  117,  116,
+
+      115,  113,  112,  111,  108,  107,  106,  105,  104,  103,
+      102,  100,   99,   98,   97,   96,   94,   92,   91,   90,
+       89,   88,   87,   86,   85,   83,   82,   80,   79,   78,
+       77,   76,   75,   74,   73,   72,   71,   70,   69,   68,
+       66,   65,   64,   63,   62,   61,   60,   59,   58,   57,
+       56,   55,   54,   53,   52,   51,   50,   49,   48,   47,
+       46,   45,   44,   33,   32,   27,   26,   23,   21,   20,
+       14,   13,    7,    6,    5,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+
+      164,  164,  164,  164,  164,  164,  164,  164,  164,  164,
+      164,  164,  164
     } ;
 
 static yy_state_type yy_last_accepting_state;
@@ -581,7 +584,7 @@ std::string gsFilename;
 
 #define YY_NO_INPUT 1
 #define YY_NO_UNISTD_H 1
-#line 585 "scanner.cpp"
+#line 588 "scanner.cpp"
 
 #define INITIAL 0
 #define IN_STRING 1
@@ -766,7 +769,7 @@ YY_DECL
 #line 45 "scanner.l"
 
 
-#line 770 "scanner.cpp"
+#line 773 "scanner.cpp"
 
 	if ( !(yy_init) )
 		{
@@ -819,13 +822,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 160 )
+				if ( yy_current_state >= 165 )
 					yy_c = yy_meta[(unsigned int) yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
 			++yy_cp;
 			}
-		while ( yy_current_state != 159 );
+		while ( yy_current_state != 164 );
 		yy_cp = (yy_last_accepting_cpos);
 		yy_current_state = (yy_last_accepting_state);
 
@@ -978,100 +981,105 @@ YY_RULE_SETUP
 case 27:
 YY_RULE_SETUP
 #line 74 "scanner.l"
-{ yylval.m_iLine = giLine; return DISPLAYKW; }
+{ yylval.m_iLine = giLine; return SPRITEKW; }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 76 "scanner.l"
+#line 75 "scanner.l"
+{ yylval.m_iLine = giLine; return DISPLAYKW; }
+	YY_BREAK
+case 29:
+YY_RULE_SETUP
+#line 77 "scanner.l"
 { yylval.m_iLine = giLine;
                   yylval.m_iNumber = 0;
                   return NUMBER; }
 	YY_BREAK
-case 29:
+case 30:
 YY_RULE_SETUP
-#line 80 "scanner.l"
+#line 81 "scanner.l"
 { yylval.m_iLine = giLine;
                   yylval.m_iNumber = atoi(yytext);
                   return NUMBER; }
 	YY_BREAK
-case 30:
+case 31:
 YY_RULE_SETUP
-#line 83 "scanner.l"
+#line 84 "scanner.l"
 { yylval.m_iLine = giLine;
                   yylval.m_iNumber = atoi(yytext);
                   return NUMBER; }
 	YY_BREAK
-case 31:
+case 32:
 YY_RULE_SETUP
-#line 87 "scanner.l"
+#line 88 "scanner.l"
 { yylval.m_sText = "";
                   yylval.m_iLine = giLine;
                   BEGIN(IN_STRING); }
 	YY_BREAK
-case 32:
+case 33:
 YY_RULE_SETUP
-#line 91 "scanner.l"
+#line 92 "scanner.l"
 { BEGIN(INITIAL);
                   return STRING; }
 	YY_BREAK
-case 33:
+case 34:
 YY_RULE_SETUP
-#line 94 "scanner.l"
+#line 95 "scanner.l"
 { yylval.m_sText += yytext; }
 	YY_BREAK
-case 34:
+case 35:
 YY_RULE_SETUP
-#line 96 "scanner.l"
+#line 97 "scanner.l"
 { BEGIN(IN_COMMENT); }
 	YY_BREAK
-case 35:
+case 36:
 /* rule 35 can match eol */
 YY_RULE_SETUP
-#line 98 "scanner.l"
+#line 99 "scanner.l"
 { BEGIN(INITIAL);
                   giLine++; }
 	YY_BREAK
-case 36:
-YY_RULE_SETUP
-#line 101 "scanner.l"
-{ }
-	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 103 "scanner.l"
+#line 102 "scanner.l"
 { }
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 105 "scanner.l"
+#line 104 "scanner.l"
 { }
 	YY_BREAK
 case 39:
+YY_RULE_SETUP
+#line 106 "scanner.l"
+{ }
+	YY_BREAK
+case 40:
 /* rule 39 can match eol */
 YY_RULE_SETUP
-#line 107 "scanner.l"
+#line 108 "scanner.l"
 { giLine++; }
 	YY_BREAK
-case 40:
+case 41:
 YY_RULE_SETUP
-#line 109 "scanner.l"
+#line 110 "scanner.l"
 { fprintf(stderr, "Unrecognized character encountered at line %d\n", giLine);
                   exit(1); }
 	YY_BREAK
 case YY_STATE_EOF(IN_COMMENT):
-#line 112 "scanner.l"
+#line 113 "scanner.l"
 { BEGIN(INITIAL); }
 	YY_BREAK
 case YY_STATE_EOF(IN_STRING):
-#line 113 "scanner.l"
+#line 114 "scanner.l"
 { BEGIN(INITIAL); }
 	YY_BREAK
-case 41:
+case 42:
 YY_RULE_SETUP
-#line 115 "scanner.l"
+#line 116 "scanner.l"
 ECHO;
 	YY_BREAK
-#line 1075 "scanner.cpp"
+#line 1083 "scanner.cpp"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -1364,7 +1372,7 @@ static int yy_get_next_buffer (void)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 160 )
+			if ( yy_current_state >= 165 )
 				yy_c = yy_meta[(unsigned int) yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
@@ -1392,11 +1400,11 @@ static int yy_get_next_buffer (void)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 160 )
+		if ( yy_current_state >= 165 )
 			yy_c = yy_meta[(unsigned int) yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
-	yy_is_jam = (yy_current_state == 159);
+	yy_is_jam = (yy_current_state == 164);
 
 		return yy_is_jam ? 0 : yy_current_state;
 }
@@ -2029,7 +2037,7 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 115 "scanner.l"
+#line 116 "scanner.l"
 
 
 
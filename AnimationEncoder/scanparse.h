@@ -33,6 +33,7 @@ struct ScannerData
     int m_iNumber;
     std::string m_sText;
     Animation m_oAnimation;
+    NumberedSprite m_oSprite;
     AnimationFrame m_oFrame;
     FrameElement m_oElement;
     FieldStorage m_oField;
@@ -49,5 +50,6 @@ void yyerror(const char *msg);
 void SetupScanner(const char *fname, FILE *new_file);
 
 extern std::vector<Animation> g_vAnimations; ///< Loaded animations.
+extern std::vector<NumberedSprite> g_vSprites; ///< Loaded numbered sprites.
 
 #endif
@@ -26,13 +26,193 @@ SOFTWARE.
 #include <cstdlib>
 #include <cstring>
 #include <cassert>
+#include <algorithm>
 #include "ast.h"
 #include "storage.h"
+#include "atlas.h"
+#include "prefetch.h"
+#include "trace.h"
+#include "report.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+EncoderSettings g_oSettings; ///< Settings of the encoder.
+EncoderStatistics g_oStatistics; ///< Statistics of the encoding.
 
 static std::map<EncodedSprite, int> g_mapSprites; ///< All encoded sprites.
+static std::map<SpritePixels, int> g_mapSpritePixels; ///< Pixels of all encoded sprites, for finding flipped sprites.
 static int g_iNumberWrittenFrames; ///< Number of frames in the file.
+static std::map<std::vector<std::vector<int> >, int> g_mapAnimationFrames; ///< First frame of each written animation, by the contents of its frames.
 static int g_iTotalElements; ///< Total number of sprite elements.
 static int g_iTotalSpriteSize; ///< Total size of all sprites.
+static std::vector<int> g_vSpriteGroups; ///< Group of each encoded sprite, the group that used it first.
+static int g_iSpriteGroup; ///< Group of the sprites being encoded.
+static std::vector<ReportGroup> g_vReportGroups; ///< Sprites used by each group, for the size report.
+
+EncoderSettings::EncoderSettings()
+{
+    m_bRowTable = false;
+    m_bLongRuns = false;
+    m_bRgbaRuns = false;
+    m_bFillRuns = false;
+    m_bPalette = false;
+    m_bFlipSprites = false;
+    m_bShareFrames = false;
+    m_sTileAtlas = "";
+    m_sAtlas = "";
+    m_bAtlasRaw = false;
+    m_iAtlasSize = 2048;
+    m_iAtlasPadding = 1;
+    m_bOptimal = false;
+    m_iAlphaSnap = 0;
+    m_iAlphaStep = 1;
+    m_bOpacityPlane = false;
+    m_iPrefetch = 0;
+    m_bMapFiles = true;
+    m_sSheetCache = "";
+    m_bVerify = false;
+    m_bStats = false;
+    m_sTrace = "";
+    m_sReport = "";
+}
+
+RunEnds::RunEnds()
+{
+    m_iCapped = 0;
+    m_iOpacity = 0;
+    m_iRecolour = 0;
+    m_iRowEnd = 0;
+    m_iOther = 0;
+}
+
+/**
+ * Add the counts of other runs.
+ * @param oEnds Counts to add.
+ */
+void RunEnds::Add(const RunEnds &oEnds)
+{
+    m_iCapped += oEnds.m_iCapped;
+    m_iOpacity += oEnds.m_iOpacity;
+    m_iRecolour += oEnds.m_iRecolour;
+    m_iRowEnd += oEnds.m_iRowEnd;
+    m_iOther += oEnds.m_iOther;
+}
+
+EncoderStatistics::EncoderStatistics()
+{
+    m_iDecodedSprites = 0;
+    m_iDecodedPixels = 0;
+    m_fDecodeTime = 0.0;
+    m_iGreedySize = 0;
+    m_iOptimalSize = 0;
+    m_fOptimizeTime = 0.0;
+    m_iPaletteSprites = 0;
+    m_iFlippedSprites = 0;
+    m_iSharedFrames = 0;
+    m_iSnappedPixels = 0;
+    m_iSnapSavedBytes = 0;
+    m_iSheetCacheHits = 0;
+    m_iSheetCacheWrites = 0;
+    m_iEncodedPixels = 0;
+    m_fEncodeTime = 0.0;
+    m_iStartTime = GetMicroseconds();
+}
+
+/**
+ * Print the statistics of the written output.
+ * @param iOutputSize Size of the output file.
+ */
+void EncoderStatistics::Print(int iOutputSize)
+{
+    printf("Format version:   %d\n", GetFormatVersion());
+    printf("Animation groups: %d\n", static_cast<int>(g_mapAnimGroups.size()));
+    printf("Frames:           %d\n", g_iNumberWrittenFrames);
+    if (g_oSettings.m_bShareFrames)
+        printf("Shared frames:    %d\n", m_iSharedFrames);
+    printf("Elements:         %d\n", g_iTotalElements);
+    printf("Sprites:          %d\n", static_cast<int>(g_mapSprites.size()));
+    printf("Sprite data:      %d bytes\n", g_iTotalSpriteSize);
+    if (!g_mapSpriteTable.empty())
+        printf("Sprite table:     %d sprites\n", static_cast<int>(g_mapSpriteTable.size()));
+    if (g_oSettings.m_bPalette)
+        printf("Palette sprites:  %d\n", m_iPaletteSprites);
+    if (g_oSettings.m_bFlipSprites)
+        printf("Flipped sprites:  %d\n", m_iFlippedSprites);
+    if (g_oSettings.m_iAlphaSnap > 0 || g_oSettings.m_iAlphaStep > 1)
+    {
+        printf("Snapped opacity:  %d pixels, %d bytes saved\n", m_iSnappedPixels, m_iSnapSavedBytes);
+    }
+    if (!g_oSettings.m_sSheetCache.empty())
+        printf("Sheet cache:      %d files loaded, %d files added\n", m_iSheetCacheHits, m_iSheetCacheWrites);
+    printf("Output size:      %d bytes\n", iOutputSize);
+    printf("Encoding:         %d pixels in %.3f ms", m_iEncodedPixels, m_fEncodeTime * 1000.0);
+    if (m_fEncodeTime > 0.0)
+        printf(" (%.1f Mpixel/s)", m_iEncodedPixels / m_fEncodeTime / 1000000.0);
+    printf("\n");
+    if (m_iDecodedSprites > 0)
+    {
+        printf("Decoding:         %d sprites, %d pixels in %.3f ms",
+               m_iDecodedSprites, m_iDecodedPixels, m_fDecodeTime * 1000.0);
+        if (m_fDecodeTime > 0.0)
+            printf(" (%.1f Mpixel/s)", m_iDecodedPixels / m_fDecodeTime / 1000000.0);
+        printf("\n");
+    }
+    PrintRuns();
+    if (m_iGreedySize > 0)
+    {
+        printf("Optimal runs:     %d bytes instead of %d bytes (%d saved) in %.3f ms\n",
+               m_iOptimalSize, m_iGreedySize, m_iGreedySize - m_iOptimalSize, m_fOptimizeTime * 1000.0);
+    }
+    printf("Run time:         %.3f ms\n", (GetMicroseconds() - m_iStartTime) / 1000.0);
+#ifndef _WIN32
+    struct rusage oUsage;
+    if (getrusage(RUSAGE_SELF, &oUsage) == 0)
+    {
+#ifdef __APPLE__
+        long iPeakKib = oUsage.ru_maxrss / 1024; // macOS reports bytes.
+#else
+        long iPeakKib = oUsage.ru_maxrss;
+#endif
+        printf("Peak memory:      %ld KiB\n", iPeakKib);
+    }
+#endif
+}
+
+//! Print the histogram of the run types of the written sprites.
+void EncoderStatistics::PrintRuns()
+{
+    static const char *aNames[RT_COUNT] = {"opaque", "partial", "rgba", "fill", "transparent", "recolour"};
+
+    printf("Runs:             type            runs     pixels  avg len     header    payload\n");
+    int iRuns = 0;
+    int iPixels = 0;
+    int iHeader = 0;
+    int iPayload = 0;
+    for (int i = 0; i < RT_COUNT; i++)
+    {
+        if (m_oRunLayout.m_aRuns[i] == 0) continue;
+
+        printf("                  %-11s %8d %10d %8.1f %10d %10d\n", aNames[i],
+               m_oRunLayout.m_aRuns[i], m_oRunLayout.m_aPixels[i],
+               (double)m_oRunLayout.m_aPixels[i] / m_oRunLayout.m_aRuns[i],
+               m_oRunLayout.m_aHeaderBytes[i], m_oRunLayout.m_aPayloadBytes[i]);
+        iRuns += m_oRunLayout.m_aRuns[i];
+        iPixels += m_oRunLayout.m_aPixels[i];
+        iHeader += m_oRunLayout.m_aHeaderBytes[i];
+        iPayload += m_oRunLayout.m_aPayloadBytes[i];
+    }
+    printf("                  %-11s %8d %10d %8.1f %10d %10d\n", "total",
+           iRuns, iPixels, (iRuns > 0) ? (double)iPixels / iRuns : 0.0, iHeader, iPayload);
+    printf("Block overhead:   %d bytes (sprite headers, row tables, palettes)\n", m_oRunLayout.m_iBlockBytes);
+    if (!g_oSettings.m_bOptimal)
+    {
+        printf("Run ends:         %d at a row end, %d by opacity, %d by recolouring, %d capped at %d pixels, %d by colour or type\n",
+               m_oRunEnds.m_iRowEnd, m_oRunEnds.m_iOpacity, m_oRunEnds.m_iRecolour,
+               m_oRunEnds.m_iCapped, MAX_SHORT_RUN, m_oRunEnds.m_iOther);
+    }
+}
 
 DataBlock::DataBlock()
 {
@@ -96,6 +276,31 @@ void Output::Uint8(unsigned char byte)
     m_pLast->Add(byte);
 }
 
+/**
+ * Append a sequence of bytes.
+ * @param pData Bytes to append.
+ * @param iSize Number of bytes.
+ */
+void Output::Bytes(const unsigned char *pData, int iSize)
+{
+    while (iSize > 0)
+    {
+        if (m_pLast == NULL || m_pLast->Full())
+        {
+            Uint8(*pData++);
+            iSize--;
+            continue;
+        }
+
+        int iCopy = BUF_SIZE - m_pLast->m_iUsed;
+        if (iCopy > iSize) iCopy = iSize;
+        memcpy(m_pLast->buffer + m_pLast->m_iUsed, pData, iCopy);
+        m_pLast->m_iUsed += iCopy;
+        pData += iCopy;
+        iSize -= iCopy;
+    }
+}
+
 void Output::Uint16(int iValue)
 {
     Uint8(iValue & 0xFF);
@@ -128,6 +333,37 @@ void Output::String(const std::string &str)
     }
 }
 
+/**
+ * Write an unsigned number in groups of 7 bits, least significant group
+ * first. All bytes except the last one have their highest bit set.
+ * @param iValue Value to write.
+ */
+void Output::Varint(unsigned int iValue)
+{
+    while (iValue >= 0x80)
+    {
+        Uint8((iValue & 0x7F) | 0x80);
+        iValue >>= 7;
+    }
+    Uint8(iValue);
+}
+
+/**
+ * Compute the number of bytes needed to write a number with #Varint.
+ * @param iValue Value to write.
+ * @return Number of bytes needed for writing the value.
+ */
+int Output::VarintSize(unsigned int iValue)
+{
+    int iSize = 1;
+    while (iValue >= 0x80)
+    {
+        iSize++;
+        iValue >>= 7;
+    }
+    return iSize;
+}
+
 /**
  * Reserve some space at the end of the output file.
  * @param iSize Length of the space to reserve.
@@ -361,11 +597,23 @@ public:
     int m_iFlags;
 };
 
-static int EncodeSprite(const FrameElement &fe, int *iXoffset, int *iYoffset, Output *output)
+/**
+ * Encode the sprite of a frame element, and write it if it is new.
+ * @param fe Frame element to encode.
+ * @param [out] iXoffset Horizontal offset of the sprite.
+ * @param [out] iYoffset Vertical offset of the sprite.
+ * @param [out] iFlip Element flags (0x1 vertical, 0x2 horizontal) to flip the returned sprite into the sprite of the element.
+ * @param output Output stream to write the sprite block to.
+ * @return Number of the sprite.
+ */
+static int EncodeSprite(const FrameElement &fe, int *iXoffset, int *iYoffset, int *iFlip, Output *output)
 {
     // Encode the sprite.
     Output out;
-    if (!fe.WriteSprite(&out, iXoffset, iYoffset))
+    SpritePixels oPixels;
+    RunEnds oEnds;
+    *iFlip = 0;
+    if (!fe.WriteSprite(&out, iXoffset, iYoffset, g_oSettings.m_bFlipSprites ? &oPixels : NULL, &oEnds))
     {
         fprintf(stderr, "Warning: Sprite \"%s\" cannot be created, using sprite 0\n", fe.m_sBaseImage.c_str());
         return 0;
@@ -375,32 +623,166 @@ static int EncodeSprite(const FrameElement &fe, int *iXoffset, int *iYoffset, Ou
     oEncSprite.TakeData(out.GetData(), out.GetSize());
 
     // Find sprite in written sprites.
+    TraceSpan oLookup("dedup lookup", fe.m_sBaseImage);
+    oLookup.SetBytes(oEncSprite.m_iSize);
     std::map<EncodedSprite, int>::iterator iter;
     iter = g_mapSprites.find(oEncSprite);
     if (iter != g_mapSprites.end())
         return (*iter).second;
 
+    if (g_oSettings.m_bFlipSprites)
+    {
+        // Find a written sprite that is a mirror image of this sprite.
+        for (int iFlags = 1; iFlags <= 3; iFlags++)
+        {
+            std::map<SpritePixels, int>::iterator iter2;
+            iter2 = g_mapSpritePixels.find(oPixels.Mirror((iFlags & 0x2) != 0, (iFlags & 0x1) != 0));
+            if (iter2 != g_mapSpritePixels.end())
+            {
+                g_oStatistics.m_iFlippedSprites++;
+                *iFlip = iFlags;
+                return (*iter2).second;
+            }
+        }
+    }
+
     // Write sprite block.
+    oLookup.Close();
     g_iTotalSpriteSize += oEncSprite.m_iSize - SPRITE_NON_DATA_SIZE; // Subtract header length.
     for (int idx = 0; idx < oEncSprite.m_iSize; idx++)
         output->Uint8(oEncSprite.m_pData[idx]);
+    if (g_oSettings.m_bStats)
+    {
+        g_oStatistics.m_oRunEnds.Add(oEnds);
+        DecodedSprite *pDecoded = DecodeSprite(oEncSprite.m_pData, oEncSprite.m_iSize, 0, -1, &g_oStatistics.m_oRunLayout);
+        delete pDecoded;
+    }
 
     // Store sprite for future re-use.
     std::pair<EncodedSprite, int> p(oEncSprite, g_mapSprites.size());
     iter = g_mapSprites.insert(p).first;
+    g_vSpriteGroups.push_back(g_iSpriteGroup);
+    if (g_oSettings.m_bFlipSprites)
+        g_mapSpritePixels.insert(std::make_pair(oPixels, (*iter).second));
     return (*iter).second;
 }
 
+/**
+ * Encode the sprite of a frame element, and compute the sprite element to write.
+ * @param fe Frame element to encode.
+ * @param output Output stream to write the sprite block to.
+ * @return The sprite element referencing the encoded sprite.
+ */
+static SpriteElement EncodeElement(const FrameElement &fe, Output *output)
+{
+    SpriteElement se;
+    int iFlip;
+    se.m_iSprite = EncodeSprite(fe, &se.m_iXoffset, &se.m_iYoffset, &iFlip, output);
+    if (!g_vReportGroups.empty())
+        g_vReportGroups.back().m_vSprites.push_back(se.m_iSprite);
+    if (fe.m_oDisplay.m_iKey < 0)
+    {
+        se.m_iLayerclass = 0;
+        se.m_iLayerId = 0;
+    }
+    else
+    {
+        se.m_iLayerclass = fe.m_oDisplay.m_iKey;
+        se.m_iLayerId = fe.m_oDisplay.m_iValue;
+    }
+    se.m_iFlags = 0;
+    if (fe.m_bVertFlip)    se.m_iFlags |= 0x1;
+    if (fe.m_bHorFlip)     se.m_iFlags |= 0x2;
+    if (fe.m_iAlpha == 50) se.m_iFlags |= 0x4;
+    if (fe.m_iAlpha == 75) se.m_iFlags |= 0x8;
+    se.m_iFlags ^= iFlip;
+    return se;
+}
+
+/**
+ * Write a sprite element.
+ * @param se Sprite element to write.
+ * @param output Output stream to write to.
+ */
+static void WriteElement(const SpriteElement &se, Output *output)
+{
+    output->Uint32(se.m_iSprite);
+    output->Uint16(se.m_iXoffset);
+    output->Uint16(se.m_iYoffset);
+    output->Uint8(se.m_iLayerclass);
+    output->Uint8(se.m_iLayerId);
+    output->Uint16(se.m_iFlags);
+}
+
+/**
+ * Get the contents of a frame block as a list of numbers, for comparing frames.
+ * @param iSound Sound of the frame.
+ * @param elements Sprite elements of the frame.
+ * @return The sound, followed by the fields of each element.
+ */
+static std::vector<int> GetFrameContents(int iSound, const std::vector<SpriteElement> &elements)
+{
+    std::vector<int> contents;
+    contents.push_back((iSound < 0) ? 0 : iSound);
+    for (std::vector<SpriteElement>::const_iterator iter = elements.begin(); iter != elements.end(); iter++)
+    {
+        contents.push_back(iter->m_iSprite);
+        contents.push_back(iter->m_iXoffset);
+        contents.push_back(iter->m_iYoffset);
+        contents.push_back(iter->m_iLayerclass);
+        contents.push_back(iter->m_iLayerId);
+        contents.push_back(iter->m_iFlags);
+    }
+    return contents;
+}
+
+/**
+ * Write a frame block.
+ * @param iSound Sound of the frame.
+ * @param elements Sprite elements of the frame.
+ * @param output Output stream to write to.
+ */
+static void WriteFrame(int iSound, const std::vector<SpriteElement> &elements, Output *output)
+{
+    output->Uint8('F');
+    output->Uint8('R');
+    output->Uint16((iSound < 0) ? 0 : iSound);
+    output->Uint16(elements.size());
+    for (std::vector<SpriteElement>::const_iterator iter = elements.begin(); iter != elements.end(); iter++)
+    {
+        WriteElement(*iter, output);
+        g_iTotalElements++;
+    }
+    g_iNumberWrittenFrames++;
+}
+
+/**
+ * Get the contents of the frames of an animation, for comparing animations.
+ * @param an Animation of the frames.
+ * @param frames Sprite elements of each frame of the animation.
+ * @return The contents of each frame.
+ */
+static std::vector<std::vector<int> > GetAnimationContents(const Animation &an, const std::vector<std::vector<SpriteElement> > &frames)
+{
+    std::vector<std::vector<int> > contents;
+    for (size_t i = 0; i < frames.size(); i++)
+        contents.push_back(GetFrameContents(an.m_vFrames[i].m_iSound, frames[i]));
+    return contents;
+}
+
 /**
  * Encode the frames of the provided animation
  * @param an Animation with the frames to encode.
  * @param output Output stream to write to.
+ * @param sprites Output stream to write the sprite blocks to.
  * @return Number of the first frame written.
  */
-static int EncodeFrames(const Animation &an, Output *output)
+static int EncodeFrames(const Animation &an, Output *output, Output *sprites)
 {
     int first_frame = g_iNumberWrittenFrames;
 
+    // With shared frames, the frames are written after checking the written frames.
+    std::vector<std::vector<SpriteElement> > frames;
     for (FrameConstIterator fri = an.m_vFrames.begin(); fri != an.m_vFrames.end(); fri++)
     {
         const AnimationFrame &fr = *fri;
@@ -409,45 +791,30 @@ static int EncodeFrames(const Animation &an, Output *output)
         std::vector<SpriteElement> elements;
         for (ElementConstIterator ei = fr.m_vElements.begin(); ei != fr.m_vElements.end(); ei++)
         {
-            SpriteElement se;
-            se.m_iSprite = EncodeSprite(*ei, &se.m_iXoffset, &se.m_iYoffset, output);
-            if ((*ei).m_oDisplay.m_iKey < 0)
-            {
-                se.m_iLayerclass = 0;
-                se.m_iLayerId = 0;
-            }
-            else
-            {
-                se.m_iLayerclass = (*ei).m_oDisplay.m_iKey;
-                se.m_iLayerId = (*ei).m_oDisplay.m_iValue;
-            }
-            se.m_iFlags = 0;
-            if ((*ei).m_bVertFlip)    se.m_iFlags |= 0x1;
-            if ((*ei).m_bHorFlip)     se.m_iFlags |= 0x2;
-            if ((*ei).m_iAlpha == 50) se.m_iFlags |= 0x4;
-            if ((*ei).m_iAlpha == 75) se.m_iFlags |= 0x8;
-
-            elements.push_back(se);
+            elements.push_back(EncodeElement(*ei, sprites));
         }
 
-        // Encode the frame.
-        output->Uint8('F');
-        output->Uint8('R');
-        output->Uint16((fr.m_iSound < 0) ? 0 : fr.m_iSound);
-        output->Uint16(elements.size());
-        for (std::vector<SpriteElement>::iterator iter = elements.begin(); iter != elements.end(); iter++)
+        if (g_oSettings.m_bShareFrames)
+            frames.push_back(elements);
+        else
+            WriteFrame(fr.m_iSound, elements, output);
+    }
+
+    if (g_oSettings.m_bShareFrames && !frames.empty())
+    {
+        // Only the frames of a whole written animation are shared, readers expect
+        // the first frame of an animation to start its range of frames.
+        std::vector<std::vector<int> > contents = GetAnimationContents(an, frames);
+        std::map<std::vector<std::vector<int> >, int>::const_iterator iter = g_mapAnimationFrames.find(contents);
+        if (iter != g_mapAnimationFrames.end())
         {
-            output->Uint32((*iter).m_iSprite);
-            output->Uint16((*iter).m_iXoffset);
-            output->Uint16((*iter).m_iYoffset);
-            output->Uint8((*iter).m_iLayerclass);
-            output->Uint8((*iter).m_iLayerId);
-            output->Uint16((*iter).m_iFlags);
-
-            g_iTotalElements++;
+            g_oStatistics.m_iSharedFrames += frames.size();
+            return iter->second;
         }
 
-        g_iNumberWrittenFrames++;
+        for (size_t i = 0; i < frames.size(); i++)
+            WriteFrame(an.m_vFrames[i].m_iSound, frames[i], output);
+        g_mapAnimationFrames[contents] = first_frame;
     }
     return first_frame;
 }
@@ -456,8 +823,9 @@ static int EncodeFrames(const Animation &an, Output *output)
  * Encode an animation group.
  * @param ag Animation group to encode.
  * @param output Output stream to write to.
+ * @param sprites Output stream to write the sprite blocks to.
  */
-static void EncodeAnimationGroup(const AnimationGroup &ag, Output *output)
+static void EncodeAnimationGroup(const AnimationGroup &ag, Output *output, Output *sprites)
 {
     unsigned int first_frames[4];
 
@@ -477,6 +845,23 @@ static void EncodeAnimationGroup(const AnimationGroup &ag, Output *output)
         return;
     }
 
+    TraceSpan oSpan("animation group", an->m_sName);
+    if (g_oSettings.m_sReport != "")
+    {
+        ReportGroup oGroup;
+        oGroup.m_sName = an->m_sName;
+        oGroup.m_iTileSize = an->m_iTileSize;
+        for (int idx = 0; idx < 4; idx++)
+        {
+            if (ag.m_aAnims[idx] == NULL)
+                continue;
+            oGroup.m_iViews++;
+            oGroup.m_iFrames += ag.m_aAnims[idx]->m_vFrames.size();
+        }
+        g_vReportGroups.push_back(oGroup);
+    }
+    int iStartSize = output->GetSize() + sprites->GetSize();
+
     // Encode all frames
     for (int idx = 0; idx < 4; idx++)
     {
@@ -486,7 +871,7 @@ static void EncodeAnimationGroup(const AnimationGroup &ag, Output *output)
         }
         else
         {
-            first_frames[idx] = EncodeFrames(*ag.m_aAnims[idx], output);
+            first_frames[idx] = EncodeFrames(*ag.m_aAnims[idx], output, sprites);
         }
     }
 
@@ -498,14 +883,266 @@ static void EncodeAnimationGroup(const AnimationGroup &ag, Output *output)
     output->String(an->m_sName);
     for (int idx = 0; idx < 4; idx++)
         output->Uint32(first_frames[idx]);
+    oSpan.SetBytes(output->GetSize() + sprites->GetSize() - iStartSize);
+}
+
+//! Order of encoding numbered sprites, sprites from the same images are encoded together.
+/*!
+    @param ns1 First sprite to compare.
+    @param ns2 Second sprite to compare.
+    @return \c true iff the first sprite should be encoded before the second sprite.
+ */
+static bool EncodeBefore(const NumberedSprite *ns1, const NumberedSprite *ns2)
+{
+    const FrameElement &fe1 = ns1->m_oElement;
+    const FrameElement &fe2 = ns2->m_oElement;
+    if (fe1.m_sBaseImage != fe2.m_sBaseImage)
+        return fe1.m_sBaseImage < fe2.m_sBaseImage;
+    if (fe1.m_sRecolourImage != fe2.m_sRecolourImage)
+        return fe1.m_sRecolourImage < fe2.m_sRecolourImage;
+    return ns1->m_iNumber < ns2->m_iNumber;
+}
+
+/**
+ * Get the numbered sprites in the order of encoding them.
+ * The sprites are grouped by image file so each file is loaded once for all its sprites.
+ * @return The numbered sprites.
+ */
+static std::vector<const NumberedSprite *> GetNumberedSprites()
+{
+    std::vector<const NumberedSprite *> numbered;
+    for (SpriteTableIterator iter = g_mapSpriteTable.begin(); iter != g_mapSpriteTable.end(); iter++)
+        numbered.push_back((*iter).second);
+    std::sort(numbered.begin(), numbered.end(), EncodeBefore);
+    return numbered;
+}
+
+/**
+ * Get the image files in the order of use while encoding.
+ * @param [out] pFiles Used image files, in order of use.
+ */
+static void GetImageFiles(std::vector<std::string> *pFiles)
+{
+    std::vector<const FrameElement *> elements;
+    for (GroupIterator grp = g_mapAnimGroups.begin(); grp != g_mapAnimGroups.end(); grp++)
+    {
+        for (int idx = 0; idx < 4; idx++)
+        {
+            const Animation *an = (*grp).second.m_aAnims[idx];
+            if (an == NULL)
+                continue;
+
+            for (FrameConstIterator fri = an->m_vFrames.begin(); fri != an->m_vFrames.end(); fri++)
+            {
+                for (ElementConstIterator ei = (*fri).m_vElements.begin(); ei != (*fri).m_vElements.end(); ei++)
+                    elements.push_back(&(*ei));
+            }
+        }
+    }
+    std::vector<const NumberedSprite *> numbered = GetNumberedSprites();
+    for (size_t idx = 0; idx < numbered.size(); idx++)
+        elements.push_back(&numbered[idx]->m_oElement);
+
+    pFiles->clear();
+    for (size_t idx = 0; idx < elements.size(); idx++)
+    {
+        pFiles->push_back(elements[idx]->m_sBaseImage);
+        if (elements[idx]->m_sRecolourImage != "")
+            pFiles->push_back(elements[idx]->m_sRecolourImage);
+    }
+}
+
+/**
+ * Encode the numbered sprites, and the sprite table referencing them.
+ * @param output Output stream to write to.
+ * @param sprites Output stream to write the sprite blocks to.
+ * @param table [out] Sprite table, entry \a n is the sprite element of the sprite with number \a n.
+ */
+static void EncodeSpriteTable(Output *output, Output *sprites, std::vector<SpriteElement> *table)
+{
+    TraceSpan oSpan("sprite table");
+    std::vector<const NumberedSprite *> numbered = GetNumberedSprites();
+    if (g_oSettings.m_sReport != "")
+    {
+        g_vReportGroups.push_back(ReportGroup());
+        g_vReportGroups.back().m_sName = "(sprite table)";
+    }
+
+    SpriteElement oEmpty;
+    oEmpty.m_iSprite = -1; // No sprite.
+    oEmpty.m_iXoffset = 0;
+    oEmpty.m_iYoffset = 0;
+    oEmpty.m_iLayerclass = 0;
+    oEmpty.m_iLayerId = 0;
+    oEmpty.m_iFlags = 0;
+    table->assign(g_mapSpriteTable.rbegin()->first + 1, oEmpty);
+    for (size_t idx = 0; idx < numbered.size(); idx++)
+        (*table)[numbered[idx]->m_iNumber] = EncodeElement(numbered[idx]->m_oElement, sprites);
+
+    // Output the sprite table, indexed by sprite number.
+    output->Uint8('S');
+    output->Uint8('T');
+    output->Uint32(table->size());
+    for (std::vector<SpriteElement>::iterator iter = table->begin(); iter != table->end(); iter++)
+        WriteElement(*iter, output);
+}
+
+/**
+ * Get the encoded sprite blocks.
+ * @return The sprite blocks, by sprite number.
+ */
+static std::vector<const EncodedSprite *> GetSpriteBlocks()
+{
+    std::vector<const EncodedSprite *> blocks(g_mapSprites.size());
+    for (std::map<EncodedSprite, int>::iterator iter = g_mapSprites.begin(); iter != g_mapSprites.end(); iter++)
+        blocks[(*iter).second] = &(*iter).first;
+    return blocks;
+}
+
+/**
+ * Write all sprites into atlas images, and output the atlas blocks and an
+ * atlas rectangle block for each sprite.
+ * @param sPrefix Start of the names of the atlas images.
+ * @param output Output stream to write to.
+ */
+static void EncodeAtlas(const std::string &sPrefix, Output *output)
+{
+    std::vector<const EncodedSprite *> blocks = GetSpriteBlocks();
+    std::vector<const DecodedSprite *> sprites;
+    for (size_t idx = 0; idx < blocks.size(); idx++)
+    {
+        DecodedSprite *pSprite = DecodeSprite(blocks[idx]->m_pData, blocks[idx]->m_iSize, 0, -1);
+        assert(pSprite != NULL);
+        sprites.push_back(pSprite);
+    }
+
+    SpriteAtlas atlas(g_oSettings.m_iAtlasSize, g_oSettings.m_iAtlasPadding);
+    atlas.Pack(sprites, g_vSpriteGroups);
+    atlas.Write(sPrefix, g_oSettings.m_bAtlasRaw);
+
+    for (size_t idx = 0; idx < atlas.m_vAtlas.size(); idx++)
+    {
+        // Store the name without directory, the images are next to the output file.
+        std::string sFilename = atlas.GetFilename(sPrefix, idx, g_oSettings.m_bAtlasRaw);
+        size_t iSlash = sFilename.rfind('/');
+        if (iSlash != std::string::npos)
+            sFilename = sFilename.substr(iSlash + 1);
+
+        output->Uint8('A');
+        output->Uint8('T');
+        output->Uint16(atlas.m_vAtlas[idx]->iWidth);
+        output->Uint16(atlas.m_vAtlas[idx]->iHeight);
+        output->String(sFilename);
+    }
+    for (size_t idx = 0; idx < atlas.m_vRects.size(); idx++)
+    {
+        const AtlasRect &rect = atlas.m_vRects[idx];
+        output->Uint8('A');
+        output->Uint8('R');
+        output->Uint32(rect.m_iAtlas);
+        output->Uint16(rect.m_iX);
+        output->Uint16(rect.m_iY);
+        output->Uint16(rect.m_iWidth);
+        output->Uint16(rect.m_iHeight);
+    }
+
+    for (size_t idx = 0; idx < sprites.size(); idx++)
+        delete sprites[idx];
+}
+
+/**
+ * Write the sprites of the sprite table into atlas images, and write a text
+ * file with the position of each sprite in the atlas images.
+ * @param table Sprite table, entry \a n is the sprite element of the sprite with number \a n.
+ * @param sPrefix Start of the names of the written files.
+ */
+static void WriteTileAtlas(const std::vector<SpriteElement> &table, const std::string &sPrefix)
+{
+    std::vector<const EncodedSprite *> blocks = GetSpriteBlocks();
+
+    // Decode the sprites of the table, a sprite used for several numbers is packed once.
+    std::map<int, int> packed; // Sprite block number to index in the sprites to pack.
+    std::vector<const DecodedSprite *> sprites;
+    for (size_t idx = 0; idx < table.size(); idx++)
+    {
+        int iSprite = table[idx].m_iSprite;
+        if (iSprite < 0 || packed.find(iSprite) != packed.end())
+            continue;
+
+        DecodedSprite *pSprite = DecodeSprite(blocks[iSprite]->m_pData, blocks[iSprite]->m_iSize, 0, -1);
+        assert(pSprite != NULL);
+        packed[iSprite] = sprites.size();
+        sprites.push_back(pSprite);
+    }
+
+    SpriteAtlas atlas(g_oSettings.m_iAtlasSize, g_oSettings.m_iAtlasPadding);
+    atlas.Pack(sprites, std::vector<int>());
+    atlas.Write(sPrefix, g_oSettings.m_bAtlasRaw);
+
+    std::string sTableName = sPrefix + ".txt";
+    FILE *pFile = fopen(sTableName.c_str(), "w");
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Cannot open \"%s\" for writing.\n", sTableName.c_str());
+        exit(1);
+    }
+    fprintf(pFile, "# atlas <atlas> <file> <width> <height>\n");
+    for (size_t idx = 0; idx < atlas.m_vAtlas.size(); idx++)
+    {
+        fprintf(pFile, "atlas %d %s %d %d\n", static_cast<int>(idx),
+                atlas.GetFilename(sPrefix, idx, g_oSettings.m_bAtlasRaw).c_str(),
+                atlas.m_vAtlas[idx]->iWidth, atlas.m_vAtlas[idx]->iHeight);
+    }
+    fprintf(pFile, "# sprite <number> <atlas> <x> <y> <width> <height> <u0> <v0> <u1> <v1> <x_offset> <y_offset> <flags>\n");
+    for (size_t idx = 0; idx < table.size(); idx++)
+    {
+        const SpriteElement &se = table[idx];
+        if (se.m_iSprite < 0)
+            continue;
+
+        const AtlasRect &rect = atlas.m_vRects[packed[se.m_iSprite]];
+        double fWidth = atlas.m_vAtlas[rect.m_iAtlas]->iWidth;
+        double fHeight = atlas.m_vAtlas[rect.m_iAtlas]->iHeight;
+        fprintf(pFile, "sprite %d %d %d %d %d %d %.6f %.6f %.6f %.6f %d %d %d\n",
+                static_cast<int>(idx), rect.m_iAtlas, rect.m_iX, rect.m_iY, rect.m_iWidth, rect.m_iHeight,
+                rect.m_iX / fWidth, rect.m_iY / fHeight,
+                (rect.m_iX + rect.m_iWidth) / fWidth, (rect.m_iY + rect.m_iHeight) / fHeight,
+                se.m_iXoffset, se.m_iYoffset, se.m_iFlags);
+    }
+    fclose(pFile);
+
+    for (size_t idx = 0; idx < sprites.size(); idx++)
+        delete sprites[idx];
+}
+
+/**
+ * Get the version of the file format to write, the lowest version that
+ * supports all selected encoder settings and written blocks.
+ * @return Version number of the output file.
+ */
+int GetFormatVersion()
+{
+    if (g_oSettings.m_sAtlas != "") return 512 + 8;
+    if (!g_mapSpriteTable.empty()) return 512 + 7;
+    if (g_oSettings.m_bPalette) return 512 + 6;
+    if (g_oSettings.m_bFillRuns) return 512 + 5;
+    if (g_oSettings.m_bRgbaRuns) return 512 + 4;
+    if (g_oSettings.m_bLongRuns) return 512 + 3;
+    if (g_oSettings.m_bRowTable) return 512 + 2;
+    return 512 + 1;
 }
 
 void Encode(const char *outFname)
 {
     g_iNumberWrittenFrames = 0;
+    g_mapAnimationFrames.clear();
     g_iTotalElements = 0;
     g_mapSprites.clear();
+    g_mapSpritePixels.clear();
     g_iTotalSpriteSize = 0;
+    g_vSpriteGroups.clear();
+    g_iSpriteGroup = 0;
+    g_vReportGroups.clear();
 
     Output output;
 
@@ -513,24 +1150,63 @@ void Encode(const char *outFname)
     output.Uint8('T');
     output.Uint8('H');
     output.Uint8('G');
-    output.Uint16(512+1);
+    output.Uint16(GetFormatVersion());
     output.Uint32(g_mapAnimGroups.size());
     int iAddrTotalFrames = output.Reserve(4);
     int iAddrTotalElements = output.Reserve(4);
     int iAddrTotalSprites = output.Reserve(4);
     int iAddrSumSpriteSize = output.Reserve(4);
 
+    // With an atlas, the sprites are replaced by atlas rectangles, which must be
+    // written before the frames that reference them.
+    bool bAtlas = (g_oSettings.m_sAtlas != "");
+    Output blocks;
+    Output sprites;
+    Output *pBlocks = bAtlas ? &blocks : &output;
+    Output *pSprites = bAtlas ? &sprites : &output;
+
+    if (g_oSettings.m_iPrefetch > 0)
+    {
+        std::vector<std::string> files;
+        GetImageFiles(&files);
+        StartPrefetch(files, g_oSettings.m_iPrefetch);
+    }
+
     for (GroupIterator grp = g_mapAnimGroups.begin(); grp != g_mapAnimGroups.end(); grp++)
     {
-        EncodeAnimationGroup((*grp).second, &output);
+        EncodeAnimationGroup((*grp).second, pBlocks, pSprites);
+        g_iSpriteGroup++;
+    }
+    std::vector<SpriteElement> table;
+    if (!g_mapSpriteTable.empty())
+        EncodeSpriteTable(pBlocks, pSprites, &table);
+    StopPrefetch();
+
+    if (bAtlas)
+    {
+        EncodeAtlas(g_oSettings.m_sAtlas, &output);
+
+        unsigned char *pData = blocks.GetData();
+        for (int idx = 0; idx < blocks.GetSize(); idx++)
+            output.Uint8(pData[idx]);
+        free(pData);
     }
 
     output.Write32(iAddrTotalFrames, g_iNumberWrittenFrames);
     output.Write32(iAddrTotalElements, g_iTotalElements);
     output.Write32(iAddrTotalSprites, g_mapSprites.size());
-    output.Write32(iAddrSumSpriteSize, g_iTotalSpriteSize);
+    output.Write32(iAddrSumSpriteSize, bAtlas ? 0 : g_iTotalSpriteSize);
 
     output.Write(outFname);
+
+    if (g_oSettings.m_sTileAtlas != "")
+        WriteTileAtlas(table, g_oSettings.m_sTileAtlas);
+
+    if (g_oSettings.m_sReport != "")
+        WriteReport(g_oSettings.m_sReport, g_vReportGroups, GetSpriteBlocks());
+
+    if (g_oSettings.m_bStats)
+        g_oStatistics.Print(output.GetSize());
 }
 
 // vim: et sw=4 ts=4 sts=4
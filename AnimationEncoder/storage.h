@@ -25,8 +25,91 @@ SOFTWARE.
 #ifndef STORAGE_H
 #define STORAGE_H
 
+#include "decoder.h"
+
 static const int BUF_SIZE = 100000; ///< Size of a data block in #Output.
 
+//! Settings of the encoder, selected from the command line.
+class EncoderSettings
+{
+public:
+    EncoderSettings();
+
+    bool m_bRowTable; ///< Write sprites with a row offset table (format version 514).
+    bool m_bLongRuns; ///< Allow runs longer than #MAX_SHORT_RUN pixels (format version 515).
+    bool m_bRgbaRuns; ///< Allow runs with an opacity for each pixel (format version 516).
+    bool m_bFillRuns; ///< Allow runs of pixels with a single colour (format version 517).
+    bool m_bPalette;  ///< Store the colours of a sprite in a palette if it is smaller (format version 518).
+    bool m_bOptimal;  ///< Select the runs of a sprite with the smallest total size.
+    int m_iAlphaSnap; ///< Opacities this close to fully transparent or opaque are made fully transparent or opaque.
+    int m_iAlphaStep; ///< Other partial opacities are rounded to a multiple of this step.
+    bool m_bOpacityPlane; ///< Store the opacity of a sprite in a separate plane for finding the runs.
+    int m_iPrefetch;      ///< Number of image files to read ahead of the encoder (\c 0 means no reading ahead).
+    bool m_bMapFiles;     ///< Map the input files into memory where possible, else read them.
+    std::string m_sSheetCache; ///< If not empty, directory of the tiled copies of the loaded PNG files.
+    bool m_bFlipSprites; ///< Store a sprite that is a mirror image of an earlier sprite as a flipped reference.
+    bool m_bShareFrames; ///< Refer to written frames for an animation with the same frames.
+
+    std::string m_sTileAtlas; ///< If not empty, write the numbered sprites into atlas images starting with this name.
+    std::string m_sAtlas;     ///< If not empty, store all sprites in atlas images starting with this name (format version 520).
+    bool m_bAtlasRaw;         ///< Write atlas images as raw RGBA pixels instead of PNG files.
+    int m_iAtlasSize;         ///< Maximal width and height of an atlas image.
+    int m_iAtlasPadding;      ///< Number of transparent pixels around a sprite in an atlas image.
+
+    bool m_bVerify;   ///< Decode every written sprite, and compare it with its source images.
+    bool m_bStats;    ///< Print statistics of the output after encoding.
+    std::string m_sTrace; ///< If not empty, file to write the trace events to.
+    std::string m_sReport; ///< If not empty, file to write the size report of the animation groups to.
+};
+
+//! Reasons of ending the runs of a sprite, counted while encoding it with the longest runs.
+class RunEnds
+{
+public:
+    RunEnds();
+
+    void Add(const RunEnds &oEnds);
+
+    int m_iCapped;   ///< Runs cut at #MAX_SHORT_RUN pixels without long runs, while the next run continues them.
+    int m_iOpacity;  ///< Runs ended by a change of the opacity.
+    int m_iRecolour; ///< Runs ended by a change of the recolour layer.
+    int m_iRowEnd;   ///< Runs ended at the end of a row or the sprite.
+    int m_iOther;    ///< Runs ended by a change of the colour or the run type.
+};
+
+//! Statistics of the encoding, printed with the \c --stats option.
+class EncoderStatistics
+{
+public:
+    EncoderStatistics();
+
+    void Print(int iOutputSize);
+    void PrintRuns();
+
+    int m_iDecodedSprites; ///< Number of sprites decoded while verifying.
+    int m_iDecodedPixels;  ///< Number of pixels decoded while verifying.
+    double m_fDecodeTime;  ///< Time spent on decoding while verifying, in seconds.
+
+    int m_iGreedySize;      ///< Size of the sprites when not optimizing the runs.
+    int m_iOptimalSize;     ///< Size of the sprites with optimized runs.
+    double m_fOptimizeTime; ///< Time spent on optimized encoding, in seconds.
+
+    int m_iPaletteSprites; ///< Number of sprites written with a palette.
+    int m_iFlippedSprites; ///< Number of sprites stored as a flipped earlier sprite.
+    int m_iSharedFrames;   ///< Number of animation frames referring to frames of another animation.
+    int m_iSnappedPixels;  ///< Number of pixels with a changed opacity.
+    int m_iSnapSavedBytes; ///< Size of the pixel data saved by changing the opacities (greedy runs without a palette).
+    int m_iSheetCacheHits;   ///< Number of PNG files loaded from their tiled copy in the sheet cache.
+    int m_iSheetCacheWrites; ///< Number of PNG files decoded and added to the sheet cache.
+
+    SpriteLayout m_oRunLayout; ///< Runs and bytes of the written sprites, for each run type.
+    RunEnds m_oRunEnds;        ///< Reasons of ending the runs of the written sprites.
+
+    int m_iEncodedPixels; ///< Number of pixels of the written sprites.
+    double m_fEncodeTime; ///< Time spent on encoding the written sprites, in seconds.
+    long long m_iStartTime; ///< Wall clock time at the start of the encoder, in microseconds.
+};
+
 //! Block of data in the output file.
 class DataBlock
 {
@@ -66,9 +149,12 @@ public:
     void Write(const char *fname);
 
     void Uint8(unsigned char byte);
+    void Bytes(const unsigned char *pData, int iSize);
     void Uint16(int val);
     void Uint32(unsigned int val);
     void String(const std::string &str);
+    void Varint(unsigned int val);
+    static int VarintSize(unsigned int val);
     void Write(int address, unsigned char byte);
     void Write32(int address, unsigned int iVal);
     int Reserve(int size);
@@ -101,8 +187,12 @@ public:
 bool operator<(const EncodedSprite &es1, const EncodedSprite &e2);
 
 
+int GetFormatVersion();
 void Encode(const char *outFname);
 
+extern EncoderSettings g_oSettings;
+extern EncoderStatistics g_oStatistics;
+
 #endif
 
 // vim: et sw=4 ts=4 sts=4
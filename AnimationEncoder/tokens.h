@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2012 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 #ifndef YY_YY_TOKENS_H_INCLUDED
 # define YY_YY_TOKENS_H_INCLUDED
-/* Enabling traces.  */
+/* Debug traces.  */
 #ifndef YYDEBUG
 # define YYDEBUG 0
 #endif
@@ -40,65 +45,56 @@
 extern int yydebug;
 #endif
 
-/* Tokens.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     CURLY_OPEN = 258,
-     CURLY_CLOSE = 259,
-     EQUAL = 260,
-     SEMICOL = 261,
-     LEFTKW = 262,
-     TOPKW = 263,
-     WIDTHKW = 264,
-     HEIGHTKW = 265,
-     BASE_IMGKW = 266,
-     RECOLOURKW = 267,
-     LAYERKW = 268,
-     ALPHAKW = 269,
-     HOR_FLIPKW = 270,
-     VERT_FLIPKW = 271,
-     X_OFFSETKW = 272,
-     Y_OFFSETKW = 273,
-     ANIMATIONKW = 274,
-     FRAMEKW = 275,
-     TILE_SIZEKW = 276,
-     VIEWKW = 277,
-     SOUNDKW = 278,
-     NORTHKW = 279,
-     WESTKW = 280,
-     SOUTHKW = 281,
-     EASTKW = 282,
-     ELEMENTKW = 283,
-     DISPLAYKW = 284,
-     NUMBER = 285,
-     STRING = 286
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    CURLY_OPEN = 258,              /* CURLY_OPEN  */
+    CURLY_CLOSE = 259,             /* CURLY_CLOSE  */
+    EQUAL = 260,                   /* EQUAL  */
+    SEMICOL = 261,                 /* SEMICOL  */
+    LEFTKW = 262,                  /* LEFTKW  */
+    TOPKW = 263,                   /* TOPKW  */
+    WIDTHKW = 264,                 /* WIDTHKW  */
+    HEIGHTKW = 265,                /* HEIGHTKW  */
+    BASE_IMGKW = 266,              /* BASE_IMGKW  */
+    RECOLOURKW = 267,              /* RECOLOURKW  */
+    LAYERKW = 268,                 /* LAYERKW  */
+    ALPHAKW = 269,                 /* ALPHAKW  */
+    HOR_FLIPKW = 270,              /* HOR_FLIPKW  */
+    VERT_FLIPKW = 271,             /* VERT_FLIPKW  */
+    X_OFFSETKW = 272,              /* X_OFFSETKW  */
+    Y_OFFSETKW = 273,              /* Y_OFFSETKW  */
+    ANIMATIONKW = 274,             /* ANIMATIONKW  */
+    FRAMEKW = 275,                 /* FRAMEKW  */
+    TILE_SIZEKW = 276,             /* TILE_SIZEKW  */
+    VIEWKW = 277,                  /* VIEWKW  */
+    SOUNDKW = 278,                 /* SOUNDKW  */
+    NORTHKW = 279,                 /* NORTHKW  */
+    WESTKW = 280,                  /* WESTKW  */
+    SOUTHKW = 281,                 /* SOUTHKW  */
+    EASTKW = 282,                  /* EASTKW  */
+    ELEMENTKW = 283,               /* ELEMENTKW  */
+    DISPLAYKW = 284,               /* DISPLAYKW  */
+    SPRITEKW = 285,                /* SPRITEKW  */
+    NUMBER = 286,                  /* NUMBER  */
+    STRING = 287                   /* STRING  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
+/* Value type.  */
 
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
-#endif
 
 extern YYSTYPE yylval;
 
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
+
 int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
+
 
 #endif /* !YY_YY_TOKENS_H_INCLUDED  */
@@ -0,0 +1,284 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file trace.cpp Recording of trace events, for viewing in Chrome or Perfetto.
+/*!
+    Each thread records its spans in its own buffer, a list of blocks of events. Only
+    registering a new thread takes a lock. Appending an event publishes it by increasing
+    the number of events in the block after a memory barrier, so the buffers can be
+    written to the trace file at exit while other threads are still recording.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "trace.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#if defined(__GNUC__)
+#define TRACE_THREAD_LOCAL __thread
+#define TRACE_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#define TRACE_BARRIER() // Without pthreads, only the main thread records.
+#else
+#define TRACE_THREAD_LOCAL
+#define TRACE_BARRIER()
+#endif
+
+static const int TRACE_BLOCK_SIZE = 1024; ///< Number of events in a block of a trace buffer.
+
+//! A recorded span.
+struct TraceEvent
+{
+    const char *sName;   ///< Name of the span.
+    std::string sDetail; ///< Name of the file or object of the span, if any.
+    long long iStart;    ///< Start time in microseconds.
+    long long iDuration; ///< Duration in microseconds.
+    long long iBytes;    ///< Number of handled bytes, negative if not set.
+};
+
+//! A block of recorded events of a thread.
+struct TraceBlock
+{
+    TraceEvent aEvents[TRACE_BLOCK_SIZE]; ///< Events of the block.
+    volatile int iCount;                  ///< Number of published events in \a aEvents.
+    TraceBlock * volatile pNext;          ///< Next block of the thread, if any.
+};
+
+//! Recorded events of a thread.
+struct TraceBuffer
+{
+    int iThread;          ///< Number of the thread in the trace.
+    std::string sName;    ///< Name of the thread.
+    TraceBlock *pFirst;   ///< First block of events.
+    TraceBlock *pLast;    ///< Block being filled.
+    TraceBuffer *pNext;   ///< Buffer of the next registered thread.
+};
+
+bool g_bTracing = false; ///< Whether spans are recorded.
+
+static std::string g_sTraceFilename;    ///< File to write the trace to.
+static long long g_iTraceStart;         ///< Time of starting the trace, in microseconds.
+static TraceBuffer *g_pBuffers = NULL;  ///< Buffers of the registered threads.
+static int g_iThreadCount = 0;          ///< Number of registered threads.
+static TRACE_THREAD_LOCAL TraceBuffer *g_pThreadBuffer = NULL; ///< Buffer of the current thread.
+
+#ifndef _WIN32
+static pthread_mutex_t g_oTraceMutex = PTHREAD_MUTEX_INITIALIZER; ///< Protection of the list of buffers.
+#endif
+
+//! Get the current time.
+/*!
+    @return Current time in microseconds.
+ */
+long long GetMicroseconds()
+{
+#ifndef _WIN32
+    struct timespec oTime;
+    clock_gettime(CLOCK_MONOTONIC, &oTime);
+    return (long long)oTime.tv_sec * 1000000 + oTime.tv_nsec / 1000;
+#else
+    return (long long)clock() * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+//! Get the buffer of the current thread, registering the thread if needed.
+/*!
+    @return Buffer of the current thread.
+ */
+static TraceBuffer *GetThreadBuffer()
+{
+    if (g_pThreadBuffer != NULL)
+        return g_pThreadBuffer;
+
+    TraceBuffer *pBuffer = new TraceBuffer;
+    pBuffer->pFirst = new TraceBlock;
+    pBuffer->pFirst->iCount = 0;
+    pBuffer->pFirst->pNext = NULL;
+    pBuffer->pLast = pBuffer->pFirst;
+
+#ifndef _WIN32
+    pthread_mutex_lock(&g_oTraceMutex);
+#endif
+    g_iThreadCount++;
+    pBuffer->iThread = g_iThreadCount;
+    pBuffer->sName = (g_iThreadCount == 1) ? "encoder" : "thread";
+    pBuffer->pNext = g_pBuffers;
+    TRACE_BARRIER();
+    g_pBuffers = pBuffer;
+#ifndef _WIN32
+    pthread_mutex_unlock(&g_oTraceMutex);
+#endif
+
+    g_pThreadBuffer = pBuffer;
+    return pBuffer;
+}
+
+//! Set the name of the current thread in the trace.
+/*!
+    @param sName Name of the thread.
+ */
+void SetTraceThreadName(const char *sName)
+{
+    if (g_bTracing)
+        GetThreadBuffer()->sName = sName;
+}
+
+//! Start recording a span.
+/*!
+    @param sName Name of the span.
+    @param pDetail Name of the file or object of the span, if any.
+    @return Start time of the span.
+ */
+long long TraceSpan::Begin(const char *sName, const std::string *pDetail)
+{
+    m_sName = sName;
+    if (pDetail != NULL)
+        m_sDetail = *pDetail;
+    m_iBytes = -1;
+    return GetMicroseconds();
+}
+
+//! Finish recording a span, and add it to the buffer of the thread.
+void TraceSpan::End()
+{
+    long long iEnd = GetMicroseconds();
+    if (!g_bTracing)
+        return; // Trace has been written already.
+
+    TraceBuffer *pBuffer = GetThreadBuffer();
+    TraceBlock *pBlock = pBuffer->pLast;
+    if (pBlock->iCount == TRACE_BLOCK_SIZE)
+    {
+        TraceBlock *pNew = new TraceBlock;
+        pNew->iCount = 0;
+        pNew->pNext = NULL;
+        TRACE_BARRIER();
+        pBlock->pNext = pNew;
+        pBuffer->pLast = pNew;
+        pBlock = pNew;
+    }
+
+    TraceEvent &oEvent = pBlock->aEvents[pBlock->iCount];
+    oEvent.sName = m_sName;
+    oEvent.sDetail = m_sDetail;
+    oEvent.iStart = m_iStart - g_iTraceStart;
+    oEvent.iDuration = iEnd - m_iStart;
+    oEvent.iBytes = m_iBytes;
+    TRACE_BARRIER();
+    pBlock->iCount++;
+}
+
+//! Write a string as JSON string.
+/*!
+    @param pFile File to write to.
+    @param sText Text to write.
+ */
+static void WriteJsonString(FILE *pFile, const std::string &sText)
+{
+    fputc('"', pFile);
+    for (size_t i = 0; i < sText.size(); i++)
+    {
+        unsigned char c = sText[i];
+        if (c == '"' || c == '\\')
+            fprintf(pFile, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(pFile, "\\u%04x", c);
+        else
+            fputc(c, pFile);
+    }
+    fputc('"', pFile);
+}
+
+//! Start recording a trace. The trace is written by #StopTrace, or at exit of the program.
+/*!
+    @param sFilename File to write the trace to.
+ */
+void StartTrace(const std::string &sFilename)
+{
+    g_sTraceFilename = sFilename;
+    g_iTraceStart = GetMicroseconds();
+    g_bTracing = true;
+    GetThreadBuffer(); // The main thread is the first thread.
+    atexit(StopTrace);
+}
+
+//! Stop recording, and write the recorded spans as Chrome trace events (JSON format).
+void StopTrace()
+{
+    if (!g_bTracing)
+        return;
+    g_bTracing = false;
+
+    FILE *pFile = fopen(g_sTraceFilename.c_str(), "w");
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "Trace file \"%s\" could not be opened for writing.\n", g_sTraceFilename.c_str());
+        return; // Also called at exit, do not exit again.
+    }
+
+    fprintf(pFile, "{\"traceEvents\":[\n");
+    bool bFirst = true;
+    for (TraceBuffer *pBuffer = g_pBuffers; pBuffer != NULL; pBuffer = pBuffer->pNext)
+    {
+        fprintf(pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                bFirst ? "" : ",\n", pBuffer->iThread);
+        WriteJsonString(pFile, pBuffer->sName);
+        fprintf(pFile, "}}");
+        bFirst = false;
+
+        for (TraceBlock *pBlock = pBuffer->pFirst; pBlock != NULL; pBlock = pBlock->pNext)
+        {
+            int iCount = pBlock->iCount;
+            TRACE_BARRIER();
+            for (int i = 0; i < iCount; i++)
+            {
+                const TraceEvent &oEvent = pBlock->aEvents[i];
+                fprintf(pFile, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld",
+                        oEvent.sName, pBuffer->iThread, oEvent.iStart, oEvent.iDuration);
+                if (!oEvent.sDetail.empty() || oEvent.iBytes >= 0)
+                {
+                    fprintf(pFile, ",\"args\":{");
+                    if (!oEvent.sDetail.empty())
+                    {
+                        fprintf(pFile, "\"file\":");
+                        WriteJsonString(pFile, oEvent.sDetail);
+                    }
+                    if (oEvent.iBytes >= 0)
+                        fprintf(pFile, "%s\"bytes\":%lld", oEvent.sDetail.empty() ? "" : ",", oEvent.iBytes);
+                    fprintf(pFile, "}");
+                }
+                fprintf(pFile, "}");
+            }
+        }
+    }
+    fprintf(pFile, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    if (fclose(pFile) != 0)
+        fprintf(stderr, "Trace file \"%s\" could not be written.\n", g_sTraceFilename.c_str());
+}
+
+// vim: et sw=4 ts=4 sts=4
@@ -0,0 +1,102 @@
+/*
+Copyright (c) 2014 Albert "Alberth" Hofkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//! @file trace.h Recording of trace events, for viewing in Chrome or Perfetto.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+extern bool g_bTracing;
+
+void StartTrace(const std::string &sFilename);
+void StopTrace();
+void SetTraceThreadName(const char *sName);
+long long GetMicroseconds();
+
+//! A span of time in a trace, from construction to destruction of the object.
+/*!
+    Without an active trace, the span does nothing.
+ */
+class TraceSpan
+{
+public:
+    //! Begin a span.
+    /*!
+        @param sName Name of the span (must be a string constant).
+     */
+    TraceSpan(const char *sName)
+    {
+        m_iStart = g_bTracing ? Begin(sName, NULL) : -1;
+    }
+
+    //! Begin a span about a file or other named object.
+    /*!
+        @param sName Name of the span (must be a string constant).
+        @param sDetail Name of the file or object.
+     */
+    TraceSpan(const char *sName, const std::string &sDetail)
+    {
+        m_iStart = g_bTracing ? Begin(sName, &sDetail) : -1;
+    }
+
+    //! End the span.
+    ~TraceSpan()
+    {
+        Close();
+    }
+
+    //! End the span before destruction.
+    void Close()
+    {
+        if (m_iStart >= 0)
+            End();
+        m_iStart = -1;
+    }
+
+    //! Set the number of bytes handled in the span.
+    /*!
+        @param iBytes Number of bytes.
+     */
+    void SetBytes(long long iBytes)
+    {
+        m_iBytes = iBytes;
+    }
+
+private:
+    long long Begin(const char *sName, const std::string *pDetail);
+    void End();
+
+    const char *m_sName;   ///< Name of the span.
+    std::string m_sDetail; ///< Name of the file or object of the span, if any.
+    long long m_iStart;    ///< Start time of the span in microseconds, negative if not recording.
+    long long m_iBytes;    ///< Number of bytes handled in the span, negative if not set.
+
+    TraceSpan(const TraceSpan &);            // Not copyable.
+    TraceSpan &operator=(const TraceSpan &);
+};
+
+#endif
+
+// vim: et sw=4 ts=4 sts=4